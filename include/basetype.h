@@ -3,6 +3,7 @@
 
 #include "result.h"
 #include "vec.h"
+#include <stdlib.h>
 
 /**
  * An enum that represents the various
@@ -42,6 +43,12 @@ struct libab_basetype_s {
      * The size of the param aray.
      */
     int count;
+    /**
+     * The size of the data of this type, if it can be stored
+     * inline inside a value, or 0 if it must be allocated separately.
+     * Must not exceed LIBABACUS_VALUE_INLINE_SIZE.
+     */
+    size_t inline_size;
 };
 
 typedef enum libab_basetype_variant_e libab_basetype_variant;
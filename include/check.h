@@ -0,0 +1,35 @@
+#ifndef LIBABACUS_CHECK_H
+#define LIBABACUS_CHECK_H
+
+#include "libabacus.h"
+#include "refcount.h"
+#include "result.h"
+#include "tree.h"
+
+/**
+ * Checks the body of the given function ahead of time. The types of
+ * expressions are inferred from the annotated types of the parameters
+ * and the declared types of the built-in functions they are given to.
+ * Calls whose overload is known in advance have it stored into their
+ * call site's cache, and conditionals whose condition is known to be
+ * a boolean are marked, so that its type is not checked when they run.
+ * The results are only used while the instance's function epoch
+ * stays the same.
+ * @param ab the instance the function runs in.
+ * @param function the function tree to check.
+ * @param scope the scope the function was defined in.
+ * @return the result of the check.
+ */
+libab_result libab_check_function(libab* ab, libab_tree* function,
+                                  libab_ref* scope);
+/**
+ * Determines if the given function has to be checked before it is
+ * called, because static checking is enabled and it was never checked
+ * or a function was defined or replaced since it was.
+ * @param ab the instance the function runs in.
+ * @param function the function tree to check.
+ * @return whether the function has to be checked.
+ */
+int libab_check_needed(libab* ab, libab_tree* function);
+
+#endif
@@ -0,0 +1,324 @@
+#ifndef LIBABACUS_CODE_H
+#define LIBABACUS_CODE_H
+
+#include "basetype.h"
+#include "function_list.h"
+#include "libabacus.h"
+#include "result.h"
+#include "tree.h"
+#include <stdlib.h>
+
+#define LIBABACUS_CALL_CACHE_ENTRIES 4
+#define LIBABACUS_CALL_CACHE_PARAMS 4
+
+/**
+ * The operations that can be performed by compiled code.
+ */
+enum libab_opcode_e {
+    /**
+     * Pushes the unit value.
+     */
+    CODE_UNIT,
+    /**
+     * Pushes the true value.
+     */
+    CODE_TRUE,
+    /**
+     * Pushes the false value.
+     */
+    CODE_FALSE,
+    /**
+     * Pushes the value of the number literal in the instruction's tree.
+     */
+    CODE_NUM,
+    /**
+     * Pushes the value of the variable named by the instruction's tree.
+     */
+    CODE_LOAD,
+    /**
+     * Pushes the value in the instruction's slot of the
+     * table found the instruction's depth above the current scope,
+     * falling back to looking up the instruction's tree by name.
+     */
+    CODE_LOAD_SLOT,
+    /**
+     * Discards the value on top of the stack.
+     */
+    CODE_POP,
+    /**
+     * Creates a new scope, child of the current one.
+     */
+    CODE_SCOPE_ENTER,
+    /**
+     * Discards the current scope, returning to its parent.
+     */
+    CODE_SCOPE_EXIT,
+    /**
+     * Continues execution at the instruction's target.
+     */
+    CODE_JUMP,
+    /**
+     * Pops a boolean, and continues execution at the
+     * instruction's target if it is false.
+     */
+    CODE_JUMP_FALSE,
+    /**
+     * Pops a boolean, and continues execution at the
+     * instruction's target if it is true.
+     */
+    CODE_JUMP_TRUE,
+    /**
+     * Pops a callee and the instruction's count of parameters,
+     * and pushes the result of the call.
+     */
+    CODE_CALL,
+    /**
+     * Like CODE_CALL, for calls whose result is the result of the
+     * function body being run. A call to a tree function ends the
+     * code, leaving the call to be made by the caller of the body,
+     * so that the body's frame is reused.
+     */
+    CODE_TAIL_CALL,
+    /**
+     * Pops the operands of the operator in the instruction's tree,
+     * and pushes the result of calling it.
+     */
+    CODE_OPERATOR,
+    /**
+     * Defines the function in the instruction's tree,
+     * and pushes its value.
+     */
+    CODE_FUN,
+    /**
+     * Runs the reserved operator in the instruction's tree,
+     * and pushes its result.
+     */
+    CODE_RESERVED
+};
+
+/**
+ * An overload that was previously selected for a call
+ * to a function list with parameters of the given basetypes.
+ */
+struct libab_call_cache_entry_s {
+    /**
+     * The function list that was called, or NULL
+     * if this entry is unused.
+     */
+    libab_function_list* list;
+    /**
+     * The generation of the list that was called.
+     */
+    size_t generation;
+    /**
+     * The size of the list when the overload was selected.
+     */
+    size_t list_size;
+    /**
+     * The instance's function epoch when the overload was selected.
+     */
+    size_t epoch;
+    /**
+     * The number of parameters the list was called with.
+     */
+    size_t param_count;
+    /**
+     * The basetypes of the parameters.
+     */
+    libab_basetype* types[LIBABACUS_CALL_CACHE_PARAMS];
+    /**
+     * The index of the selected overload in the list.
+     */
+    size_t index;
+    /**
+     * Whether the selected overload has type parameters,
+     * which have to be resolved again for every call.
+     */
+    int generic;
+};
+
+/**
+ * A small cache of the overloads selected by a single call site,
+ * as well as the function of the operator it calls, if any.
+ */
+struct libab_call_cache_s {
+    /**
+     * The cached overloads.
+     */
+    struct libab_call_cache_entry_s entries[LIBABACUS_CALL_CACHE_ENTRIES];
+    /**
+     * The index of the entry to replace when the cache is full.
+     */
+    size_t next;
+    /**
+     * The entry holding the function of the operator called by this
+     * site, or NULL if it was not yet resolved.
+     */
+    libab_table_entry* function;
+    /**
+     * The table holding the function's entry.
+     */
+    libab_table* owner;
+    /**
+     * The id of the owner, to tell it apart from a table
+     * later allocated at the same address.
+     */
+    size_t owner_id;
+    /**
+     * The generation of the owner when the function was resolved.
+     */
+    size_t owner_generation;
+    /**
+     * The operator epoch at which the function was resolved.
+     */
+    size_t operator_epoch;
+};
+
+/**
+ * A single instruction of compiled code.
+ */
+struct libab_instruction_s {
+    /**
+     * The operation this instruction performs.
+     */
+    enum libab_opcode_e op;
+    /**
+     * The tree node this instruction was compiled from.
+     */
+    libab_tree* tree;
+    /**
+     * The jump target, parameter count or slot, if applicable.
+     */
+    size_t arg;
+    /**
+     * The number of scopes between the scope this instruction
+     * runs in and the scope of the function call, if any.
+     */
+    size_t depth;
+    /**
+     * The overloads previously selected by this instruction,
+     * if it is a call, or NULL if it was never run.
+     */
+    struct libab_call_cache_s* cache;
+};
+
+/**
+ * A tree compiled into a flat sequence of instructions.
+ */
+struct libab_code_s {
+    /**
+     * The scope mode the tree was compiled with.
+     */
+    libab_interpreter_scope_mode mode;
+    /**
+     * The instructions of this code.
+     */
+    struct libab_instruction_s* instructions;
+    /**
+     * The number of instructions.
+     */
+    size_t size;
+    /**
+     * The number of instructions that fit into
+     * the allocated memory.
+     */
+    size_t capacity;
+    /**
+     * The maximum number of values on the stack
+     * at any point of the execution.
+     */
+    size_t max_stack;
+    /**
+     * The maximum number of scopes created by the code
+     * that are alive at any point of the execution.
+     */
+    size_t max_scopes;
+};
+
+typedef enum libab_opcode_e libab_opcode;
+typedef struct libab_call_cache_entry_s libab_call_cache_entry;
+typedef struct libab_call_cache_s libab_call_cache;
+typedef struct libab_instruction_s libab_instruction;
+typedef struct libab_code_s libab_code;
+
+/**
+ * Compiles the given tree, resolving the targets of all jumps.
+ * @param code the code to initialize.
+ * @param tree the tree to compile.
+ * @param mode the scope mode to run the tree with.
+ * @return the result of the compilation.
+ */
+libab_result libab_code_init(libab_code* code, libab_tree* tree,
+                             libab_interpreter_scope_mode mode);
+/**
+ * Compiles the body of the given function, resolving references
+ * to the function's parameters to slots of its call scope. Calls
+ * in tail position are compiled into tail calls.
+ * @param code the code to initialize.
+ * @param function the function tree whose body to compile.
+ * @return the result of the compilation.
+ */
+libab_result libab_code_init_function(libab_code* code, libab_tree* function);
+/**
+ * Compiles the given tree, resolving references to the given
+ * variables to the slots of the scope the code is run in.
+ * @param code the code to initialize.
+ * @param tree the tree to compile.
+ * @param mode the scope mode to run the tree with.
+ * @param bound the symbols of the variables, in the order of their slots.
+ * @param count the number of variables.
+ * @return the result of the compilation.
+ */
+libab_result libab_code_init_bound(libab_code* code, libab_tree* tree,
+                                   libab_interpreter_scope_mode mode,
+                                   const size_t* bound, size_t count);
+/**
+ * Finds the overload previously selected for a call to the given
+ * list with the given parameters.
+ * @param cache the cache to search.
+ * @param epoch the current function epoch of the instance.
+ * @param list the list being called.
+ * @param params the parameters the list is being called with.
+ * @return the matching entry, or NULL if there is none.
+ */
+libab_call_cache_entry* libab_call_cache_find(libab_call_cache* cache,
+                                              size_t epoch,
+                                              libab_function_list* list,
+                                              libab_ref_vec* params);
+/**
+ * Records the overload selected for a call to the given list
+ * with the given parameters. Calls whose parameters have
+ * parameterized types are not recorded.
+ * @param cache the cache to store into.
+ * @param epoch the current function epoch of the instance.
+ * @param list the list being called.
+ * @param params the parameters the list is being called with.
+ * @param index the index of the selected overload.
+ * @param generic whether the selected overload has type parameters.
+ */
+void libab_call_cache_store(libab_call_cache* cache, size_t epoch,
+                            libab_function_list* list, libab_ref_vec* params,
+                            size_t index, int generic);
+/**
+ * Records the overload selected for a call to the given list
+ * with parameters of the given basetypes, none of which may
+ * be parameterized.
+ * @param cache the cache to store into.
+ * @param epoch the current function epoch of the instance.
+ * @param list the list being called.
+ * @param types the basetypes of the parameters.
+ * @param count the number of parameters, at most LIBABACUS_CALL_CACHE_PARAMS.
+ * @param index the index of the selected overload.
+ * @param generic whether the selected overload has type parameters.
+ */
+void libab_call_cache_store_types(libab_call_cache* cache, size_t epoch,
+                                  libab_function_list* list,
+                                  libab_basetype** types, size_t count,
+                                  size_t index, int generic);
+/**
+ * Frees the given code.
+ * @param code the code to free.
+ */
+void libab_code_free(libab_code* code);
+
+#endif
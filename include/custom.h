@@ -73,6 +73,49 @@ struct libab_operator_s {
      * The function called by this operator.
      */
     const char* function;
+    /**
+     * The symbol of the function called by this operator.
+     */
+    size_t function_symbol;
+};
+
+/**
+ * The maximum number of parameters a call can have
+ * for its specialization to be remembered.
+ */
+#define LIBABACUS_SPECIALIZATION_PARAMS 4
+/**
+ * The number of specializations remembered by every function.
+ */
+#define LIBABACUS_SPECIALIZATIONS 4
+
+/**
+ * The outcome of checking the parameters of a call against the type
+ * of the function being called, remembered so that calls with
+ * parameters of the same types don't have to check them again.
+ */
+struct libab_specialization_s {
+    /**
+     * The type of the function value that was called, or
+     * a null reference if this specialization is unused.
+     */
+    libab_ref function_type;
+    /**
+     * The number of parameters the call was made with.
+     */
+    size_t param_count;
+    /**
+     * The canonical types of the parameters.
+     */
+    libab_parsetype* param_types[LIBABACUS_SPECIALIZATION_PARAMS];
+    /**
+     * The types the parameters are cast to.
+     */
+    libab_ref_vec new_types;
+    /**
+     * The type parameters bound by the call.
+     */
+    libab_ref_trie param_map;
 };
 
 /**
@@ -94,6 +137,15 @@ struct libab_function_s {
      * The scope in which this function was declared.
      */
     libab_ref scope;
+    /**
+     * The specializations made by previous calls to this function,
+     * or NULL if none were made yet.
+     */
+    struct libab_specialization_s* specializations;
+    /**
+     * The index of the specialization to replace when all are used.
+     */
+    size_t next_specialization;
 };
 
 typedef enum libab_operator_variant_e libab_operator_variant;
@@ -101,6 +153,7 @@ typedef enum libab_behavior_variant_e libab_behavior_variant;
 typedef struct libab_behavior_s libab_behavior;
 typedef struct libab_operator_s libab_operator;
 typedef struct libab_function_s libab_function;
+typedef struct libab_specialization_s libab_specialization;
 
 /**
  * Initializes a behavior that uses an internal function.
@@ -174,6 +227,31 @@ libab_result libab_function_init_tree(libab_function* function,
 libab_result libab_function_init_behavior(libab_function* function,
                                           libab_behavior* behavior,
                                           libab_ref* scope);
+/**
+ * Finds the specialization made by a previous call to the function
+ * value of the given type with parameters of the same types.
+ * @param function the function being called.
+ * @param type the type of the function value being called.
+ * @param params the parameters of the call.
+ * @return the specialization, or NULL if there is none.
+ */
+libab_specialization* libab_function_find_specialization(
+    libab_function* function, libab_ref* type, libab_ref_vec* params);
+/**
+ * Remembers the outcome of checking the parameters of a call, if the
+ * types of the parameters are canonical. The specialization stays
+ * valid until the next specialization is stored into the function.
+ * @param function the function being called.
+ * @param type the type of the function value being called.
+ * @param params the parameters of the call.
+ * @param new_types the types the parameters are cast to.
+ * @param param_map the type parameters bound by the call.
+ * @return the specialization, which takes over the given vector and trie,
+ * or NULL if it could not be stored, in which case they are left as they are.
+ */
+libab_specialization* libab_function_store_specialization(
+    libab_function* function, libab_ref* type, libab_ref_vec* params,
+    libab_ref_vec* new_types, libab_ref_trie* param_map);
 /**
  * Frees the given function.
  * @param fun the function to free.
@@ -29,6 +29,12 @@ void libab_free_unit(void* unit);
  * @param b the bool to free.
  */
 void libab_free_bool(void* b);
+/**
+ * Frees the contents of a value stored in a single allocation.
+ * The memory of the value is released along with its reference count.
+ * @param value the value to free.
+ */
+void libab_free_value_inline(void* value);
 /**
  * Frees a parsetype.
  * @param parsetype the parsetype to free.
@@ -39,6 +45,11 @@ void libab_free_parsetype(void* parsetype);
  * @param table the table to free.
  */
 void libab_free_table(void* table);
+/**
+ * Frees a parse tree and its children.
+ * @param tree the tree to free.
+ */
+void libab_free_tree(void* tree);
 /**
  * Frees a value.
  * @param value the value to free.
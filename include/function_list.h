@@ -3,6 +3,23 @@
 
 #include "ref_vec.h"
 
+#define LIBABACUS_FUNCTION_LIST_INITIAL_SLOTS 8
+
+/**
+ * A slot of a function list's overload index.
+ */
+struct libab_function_list_slot_s {
+    /**
+     * The hash of the overload's arity and parameter basetypes.
+     */
+    unsigned long hash;
+    /**
+     * One more than the index of the overload in the list,
+     * or 0 if this slot is empty.
+     */
+    size_t index;
+};
+
 /**
  * A list of function values,
  * returned if a name of an overloaded
@@ -13,9 +30,91 @@ struct libab_function_list_s {
      * The function list.
      */
     libab_ref_vec functions;
+    /**
+     * A number identifying this list among all the lists created
+     * by an instance and its clones, so that a list allocated where
+     * a freed one used to be is not mistaken for it.
+     */
+    size_t generation;
+    /**
+     * The open addressing index of the overloads whose parameters
+     * all have known basetypes, keyed by their arity and these
+     * basetypes, or NULL if there are no such overloads.
+     */
+    struct libab_function_list_slot_s* slots;
+    /**
+     * The number of slots, which is always a power of two.
+     */
+    size_t slot_count;
+    /**
+     * The number of overloads in the index.
+     */
+    size_t indexed;
+    /**
+     * The indices of the overloads that have a type parameter
+     * in place of a parameter type, which may accept
+     * parameters of any basetype.
+     */
+    size_t* polymorphic;
+    /**
+     * The number of polymorphic overloads.
+     */
+    size_t polymorphic_count;
+    /**
+     * The number of polymorphic overloads that fit
+     * into the allocated memory.
+     */
+    size_t polymorphic_capacity;
 };
 
+/**
+ * The overloads a function list search is looking at.
+ */
+enum libab_function_list_phase_e {
+    /**
+     * The indexed overloads with the parameters' arity and basetypes.
+     */
+    SEARCH_INDEXED,
+    /**
+     * The polymorphic overloads.
+     */
+    SEARCH_POLYMORPHIC,
+    /**
+     * All overloads, since the parameters can't be used as a key.
+     */
+    SEARCH_ALL
+};
+
+/**
+ * A search for the overloads in a function list that
+ * may accept a given list of parameters.
+ */
+struct libab_function_list_search_s {
+    /**
+     * The list being searched.
+     */
+    struct libab_function_list_s* list;
+    /**
+     * The parameters the overloads have to accept.
+     */
+    libab_ref_vec* params;
+    /**
+     * The hash of the parameters' count and basetypes.
+     */
+    unsigned long hash;
+    /**
+     * The overloads currently being searched.
+     */
+    enum libab_function_list_phase_e phase;
+    /**
+     * The next slot or index to look at in the current phase.
+     */
+    size_t position;
+};
+
+typedef struct libab_function_list_slot_s libab_function_list_slot;
 typedef struct libab_function_list_s libab_function_list;
+typedef struct libab_function_list_search_s libab_function_list_search;
 
 /**
  * Initializes a function list.
@@ -45,6 +144,27 @@ size_t libab_function_list_size(libab_function_list* list);
  */
 void libab_function_list_index(libab_function_list* list, size_t index,
                                libab_ref* into);
+/**
+ * Starts a search for the overloads in the list that may accept the
+ * given parameters. Every overload that can be called with them is
+ * found, along with a few others that need to be checked. Overloads
+ * that have to be partially applied are only found by a search of all
+ * overloads. The list must not change while the search runs.
+ * @param list the list to search.
+ * @param params the parameters, or NULL to search all overloads.
+ * @param search the search to initialize.
+ */
+void libab_function_list_search_init(libab_function_list* list,
+                                     libab_ref_vec* params,
+                                     libab_function_list_search* search);
+/**
+ * Finds the next overload of a search.
+ * @param search the search to continue.
+ * @param index the location to store the index of the overload into.
+ * @return whether an overload was found.
+ */
+int libab_function_list_search_next(libab_function_list_search* search,
+                                    size_t* index);
 /**
  * Frees the given function list.
  * @param list the list to free.
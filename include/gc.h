@@ -4,6 +4,17 @@
 #include "refcount.h"
 #include "gc_functions.h"
 
+/**
+ * The default number of containers that can be allocated
+ * before a garbage collection cycle is run automatically.
+ */
+#define LIBABACUS_GC_DEFAULT_THRESHOLD 1024
+/**
+ * The default number of young generation collections
+ * that are performed for every full collection.
+ */
+#define LIBABACUS_GC_DEFAULT_MAJOR_INTERVAL 8
+
 /**
  * Struct used to create an interface
  * for a set of objects to be collected.
@@ -17,6 +28,12 @@ struct libab_gc_list_s {
      * The tail sentinel node.
      */
     struct libab_ref_count_s tail_sentinel;
+    /**
+     * The instance whose containers this list tracks.
+     * Containers owned by other instances are never
+     * collected or moved by collections of this list.
+     */
+    void* owner;
 };
 
 typedef struct libab_gc_list_s libab_gc_list;
@@ -24,8 +41,9 @@ typedef struct libab_gc_list_s libab_gc_list;
 /**
  * Initializes a garbage collection tracking list.
  * @param list the list to initialize.
+ * @param owner the instance whose containers the list tracks.
  */
-void libab_gc_list_init(libab_gc_list* list);
+void libab_gc_list_init(libab_gc_list* list, void* owner);
 /**
  * Visits the children of the current node, applying the given function to them.
  * @param ref the reference whose children to visit.
@@ -39,7 +57,8 @@ void libab_gc_visit_children(struct libab_ref_s* ref, libab_visitor_function_ptr
 void libab_gc_visit(struct libab_ref_s* ref, libab_visitor_function_ptr visitor, void* data);
 /**
  * Adds the given reference to the given garbage collection list,
- * and specifies a function used to reach its children.
+ * making it owned by the list's owner, and specifies a function
+ * used to reach its children.
  * @param ref the reference whose children to visit.
  * @param visit_children the function used to reach the chilren of this reference.
  * @param list the list to which to add the reference.
@@ -47,10 +66,26 @@ void libab_gc_visit(struct libab_ref_s* ref, libab_visitor_function_ptr visitor,
 void libab_gc_add(struct libab_ref_s* ref,
                       libab_visit_function_ptr visit_children,
                       libab_gc_list* list);
+/**
+ * Moves all the references from one garbage collection list
+ * to the end of another, leaving the first list empty.
+ * @param into the list to move the references into.
+ * @param from the list to move the references from.
+ */
+void libab_gc_list_merge(libab_gc_list* into, libab_gc_list* from);
 /**
  * Performs garbage collection on a given list of container objects/
  * @param list the list to run collection on.
  */
 void libab_gc_run(libab_gc_list* list);
+/**
+ * Performs garbage collection on a given list of container objects,
+ * moving the containers that survive into another list. Containers
+ * in the other list are not collected, and references from them
+ * are treated as external references.
+ * @param list the list to run collection on.
+ * @param into the list into which to move the surviving containers.
+ */
+void libab_gc_run_promote(libab_gc_list* list, libab_gc_list* into);
 
 #endif
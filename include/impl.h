@@ -9,6 +9,12 @@ struct libab_impl_s {
      * Function to parse a number from a string.
      */
     void* (*parse_num)(const char*);
+    /**
+     * Function to parse a number from a string into
+     * the given buffer, used instead of parse_num when
+     * numbers are stored inline. Can be NULL.
+     */
+    void (*parse_num_inline)(const char*, void*);
 };
 
 typedef struct libab_impl_s libab_impl;
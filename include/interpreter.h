@@ -7,6 +7,8 @@
 #include "tree.h"
 
 struct libab_s;
+struct libab_code_s;
+struct libab_call_cache_s;
 
 /**
  * Scope moe used to determine how the interpreter handles
@@ -61,6 +63,18 @@ libab_result libab_interpreter_run(libab_interpreter* intr, libab_tree* tree,
                                    libab_ref* scope,
                                    libab_interpreter_scope_mode mode,
                                    libab_ref* into);
+/**
+ * Uses the interpreter to run already compiled code.
+ * @param intr the interpreter to use to run the code.
+ * @param code the code to run.
+ * @param scope the scope to run the code in.
+ * @param into the reference into which the result of the execution will be
+ * stored.
+ * @return the result of the execution.
+ */
+libab_result libab_interpreter_run_code(libab_interpreter* intr,
+                                        struct libab_code_s* code,
+                                        libab_ref* scope, libab_ref* into);
 /**
  * Calls a function with the given parameters.
  * @param intr the interpreter to use to call the function.
@@ -89,6 +103,38 @@ libab_result libab_interpreter_call_value(libab_interpreter* intr,
                                          libab_ref* function,
                                          libab_ref_vec* params,
                                          libab_ref* into);
+/**
+ * Calls a function value with the given parameters, remembering
+ * the overloads it selects in the given cache.
+ * @param intr the interpreter to use to call the function.
+ * @param scope the scope in which to perform the call.
+ * @param function the function to call.
+ * @param params the parameters to pass to the function.
+ * @param cache the cache of overloads previously selected by
+ * calls made with it, or NULL.
+ * @param into the reference to store the result into.
+ * @return the result of the call.
+ */
+libab_result libab_interpreter_call_cached(libab_interpreter* intr,
+                                          libab_ref* scope,
+                                          libab_ref* function,
+                                          libab_ref_vec* params,
+                                          struct libab_call_cache_s* cache,
+                                          libab_ref* into);
+/**
+ * Finds the single function that a call to the given function value
+ * with the given parameters would be made to.
+ * @param intr the interpreter to use to search for the function.
+ * @param function the function or function list to search.
+ * @param params the parameters of the call.
+ * @param into the reference to store the function into.
+ * @return the result of the search, which is LIBAB_BAD_CALL if
+ * no function accepts the parameters.
+ */
+libab_result libab_interpreter_select_overload(libab_interpreter* intr,
+                                               libab_ref* function,
+                                               libab_ref_vec* params,
+                                               libab_ref* into);
 /**
  * Gets the unit value from this interpreter.
  * @param intr the interpreter from which to get the unit value.
@@ -6,10 +6,21 @@
 #include "impl.h"
 #include "interpreter.h"
 #include "lexer.h"
+#include "parse_cache.h"
 #include "parser.h"
 #include "result.h"
 #include "table.h"
 #include "gc.h"
+#include "ref_pool.h"
+#include "ref_trie.h"
+#include "symbol.h"
+#include "type_interner.h"
+
+/**
+ * The maximum number of distinct number literals
+ * whose values an instance keeps for reuse.
+ */
+#define LIBABACUS_LITERALS_MAX 256
 
 /**
  * The main struct of libabacus,
@@ -61,11 +72,108 @@ struct libab_s {
      */
     libab_ref type_unit;
     /**
-     * List of containers references
-     * that should be tracked by the
-     * garbage collector for cycles.
+     * List of recently allocated container references
+     * that should be tracked by the garbage collector for
+     * cycles. This list is collected frequently.
+     */
+    libab_gc_list young_containers;
+    /**
+     * List of container references that have survived
+     * a collection of the young list. This list is only
+     * collected during full garbage collection cycles.
+     */
+    libab_gc_list old_containers;
+    /**
+     * The number of containers that can be allocated
+     * before garbage collection is triggered automatically.
+     * A value of 0 disables automatic collection.
+     */
+    size_t gc_threshold;
+    /**
+     * The number of automatic collections of the young
+     * containers that are performed for every full collection.
+     * A value of 0 disables automatic full collection.
+     */
+    size_t gc_major_interval;
+    /**
+     * The number of containers allocated since the
+     * last garbage collection cycle.
+     */
+    size_t gc_allocations;
+    /**
+     * The number of young collections performed since
+     * the last full garbage collection cycle.
+     */
+    size_t gc_minor_collections;
+    /**
+     * The values of number literals that have already been
+     * evaluated by this instance, keyed by their text, so that
+     * identical literals share a single value.
+     */
+    libab_ref_trie literals;
+    /**
+     * The number of values in the literals trie, which is
+     * emptied once it reaches LIBABACUS_LITERALS_MAX.
+     */
+    size_t literal_count;
+    /**
+     * The pool from which the reference counts of
+     * containers created by this instance are allocated.
+     */
+    libab_ref_pool* ref_pool;
+    /**
+     * The symbol table in which the names of identifiers,
+     * operators and table entries are interned. Clones intern
+     * names in their first prototype's symbol table instead,
+     * so that a name is the same symbol in all their tables.
+     */
+    libab_symbols symbols;
+    /**
+     * The generation of the last function list created by this
+     * instance. Clones take their generations from their first
+     * prototype instead, so that they never reuse one.
+     */
+    size_t function_list_generation;
+    /**
+     * Incremented every time an operator or a basetype is registered
+     * with this instance or one of its clones, so that the trees cached
+     * by any of them are not reused with the new syntax. Only the first
+     * prototype's generation is used.
+     */
+    size_t parse_generation;
+    /**
+     * The state shared by the tables created by this instance.
+     * Clones create their tables with their first prototype's
+     * state instead, so that tables of the same family can
+     * be told apart, see each other's operators, and advance
+     * the same function epoch.
+     */
+    libab_table_shared tables;
+    /**
+     * Whether functions are checked ahead of time, when they
+     * are defined, so that they run with fewer runtime checks.
+     */
+    int static_checks;
+    /**
+     * The trees parsed from source text previously
+     * given to libab_run and libab_run_scoped.
+     */
+    libab_parse_cache parse_cache;
+    /**
+     * The canonical types of this instance, so that
+     * fully resolved types can be compared by address.
+     */
+    libab_type_interner types;
+    /**
+     * The instance this instance was cloned from, whose
+     * global scope, types and lexer it shares, or NULL.
      */
-    libab_gc_list containers;
+    struct libab_s* prototype;
+    /**
+     * Whether the lexer of this instance was initialized. Clones use
+     * their prototype's lexer until they register an operator.
+     */
+    int owns_lexer;
 
     /**
      * Internal; the number basetype. This cannot be a static
@@ -75,7 +183,62 @@ struct libab_s {
     libab_basetype basetype_num;
 };
 
+/**
+ * An expression that was parsed and compiled once, so that
+ * it can be run many times with different values bound
+ * to its free variables.
+ */
+struct libab_prepared_s {
+    /**
+     * The parse tree of the expression.
+     */
+    libab_tree* tree;
+    /**
+     * The code of the expression, which loads the bound
+     * variables from the slots of the bindings table.
+     */
+    struct libab_code_s* code;
+    /**
+     * The table whose slots hold the values of the bound variables.
+     * Its parent is the scope the expression last ran in.
+     */
+    libab_ref bindings;
+    /**
+     * The symbols of the bound variables, with which a new bindings
+     * table is created when values from a previous run still hold
+     * on to the old one.
+     */
+    size_t* symbols;
+    /**
+     * The number of bound variables.
+     */
+    size_t count;
+};
+
+/**
+ * A function that was looked up once, so that the host
+ * can call it many times without searching for it by name.
+ */
+struct libab_function_handle_s {
+    /**
+     * The function or function list to call.
+     */
+    libab_ref function;
+    /**
+     * The scope the function was looked up in,
+     * and in which calls to it are performed.
+     */
+    libab_ref scope;
+    /**
+     * The overloads selected by previous calls through this
+     * handle, or NULL if the cache couldn't be allocated.
+     */
+    struct libab_call_cache_s* cache;
+};
+
 typedef struct libab_s libab;
+typedef struct libab_prepared_s libab_prepared;
+typedef struct libab_function_handle_s libab_function_handle;
 
 /**
  * Initializes the libabacus struct as well
@@ -87,6 +250,19 @@ typedef struct libab_s libab;
  */
 libab_result libab_init(libab* ab, void* (*parse_function)(const char*),
                         void (*free_function)(void*));
+/**
+ * Initializes the libabacus struct as a clone of another instance.
+ * Rather than being copied, everything registered with the prototype
+ * is shared with the clone, whose global scope is layered on top of the
+ * prototype's. Registering more with the clone doesn't affect the
+ * prototype, and what the prototype defines later is seen by the clone.
+ * The prototype must not be freed for as long as any of its clones
+ * are in use.
+ * @param ab the libabacus instance to initialize.
+ * @param prototype the instance to clone.
+ * @return the result of the initialization.
+ */
+libab_result libab_init_clone(libab* ab, libab* prototype);
 /**
  * Registers an operator with libabacus.
  * @param ab the libabacus instance to reigster the operator with.
@@ -139,22 +315,75 @@ libab_result libab_register_function(libab* ab, const char* name,
  */
 libab_result libab_register_basetype(libab* ab, const char* name,
                                      libab_basetype* basetype);
+/**
+ * Compacts the global scope, which all code runs on top of, into
+ * a read-only perfect hash. This should be called once all functions,
+ * operators and basetypes are registered; registering anything
+ * afterwards undoes it.
+ * @param ab the libabacus instance whose global scope to freeze.
+ * @return the result of the operation.
+ */
+libab_result libab_freeze(libab* ab);
 /**
  * Constructs and resolves a parse type, similarly to how it's done in the
- * parser.
+ * parser. The resulting type is canonical if it is fully resolved.
  * @param ab the libab instance to use for constructing the type.
  * @param into the reference to populate with the given type.
  * @param type the type to parse.
  * @return the result of the operation.
  */
 libab_result libab_create_type(libab* ab, libab_ref* into, const char* type);
+/**
+ * Replaces a fully resolved type with the instance's canonical type
+ * of the same structure, so that it shares its memory with equal types
+ * and is compared to them by address. The type must not be modified
+ * afterwards.
+ * @param ab the libab instance whose canonical types to use.
+ * @param type the reference to the type to replace.
+ * @return the result of the operation, which leaves the
+ * reference unchanged if it fails.
+ */
+libab_result libab_intern_type(libab* ab, libab_ref* type);
 
+/**
+ * Gets the first prototype of the given instance,
+ * or the instance itself if it is not a clone.
+ * @param ab the instance whose first prototype to get.
+ * @return the first prototype.
+ */
+libab* libab_get_root(libab* ab);
+/**
+ * Checks whether the given value is a function or a function list.
+ * @param value the value to check, which may be null.
+ * @return whether the value can be called.
+ */
+int libab_value_callable(libab_ref* value);
+/**
+ * Gets the symbol table the given instance interns names in,
+ * which is its first prototype's for clones.
+ * @param ab the instance whose symbol table to get.
+ * @return the symbol table.
+ */
+libab_symbols* libab_get_symbols(libab* ab);
 /**
  * Finds and returns the built-in libabacus number type.
  * @param ab the ab instance for which to return a type.
  * @return the num basetype.
  */
 libab_basetype* libab_get_basetype_num(libab* ab);
+/**
+ * Declares that numbers are plain data of the given size, which
+ * is stored inline in values instead of being allocated separately.
+ * Number values should then be created using libab_create_value_inline.
+ * @param ab the ab instance whose number type to change.
+ * @param size the size of a number, at most LIBABACUS_VALUE_INLINE_SIZE.
+ * @param parse_function function used to parse a number into a buffer.
+ * @return the result of the declaration, which is LIBAB_BAD_CALL
+ * for clones, as they share their prototype's number type.
+ */
+libab_result libab_declare_num_inline(libab* ab, size_t size,
+                                      void (*parse_function)(const char*,
+                                                             void*));
 /**
  * Finds and returns the built-in libabacus boolean type.
  * @param ab the ab instance for which to return a type.
@@ -239,6 +468,37 @@ void libab_get_bool_value(libab* ab, int val, libab_ref* into);
  * @param into the value to store the newly parsed tree into.
  */
 libab_result libab_parse(libab* ab, const char* string, libab_tree** into);
+/**
+ * Parses the given string, reusing the tree previously parsed
+ * from the same string if it is in the instance's parse cache.
+ * @param ab the libabacus instance to use to parse the string.
+ * @param string the string to parse.
+ * @param into the reference to store the shared tree into.
+ * @return the result of the parse.
+ */
+libab_result libab_parse_shared(libab* ab, const char* string,
+                                libab_ref* into);
+/**
+ * Sets the number of trees the instance's parse cache holds.
+ * The cache is cleared whenever an operator or basetype
+ * is registered, as that changes how strings are parsed;
+ * registering one with a prototype or another clone also
+ * keeps the trees this instance cached from being reused.
+ * @param ab the libabacus instance whose cache to resize.
+ * @param size the number of trees to keep, or 0 to disable the cache.
+ * @return the result of the operation.
+ */
+libab_result libab_set_parse_cache_size(libab* ab, size_t size);
+/**
+ * Enables or disables static checking. When it is enabled, the body of
+ * every function is checked when the function is defined, and again
+ * when it is called after functions were defined or replaced. Calls
+ * whose overload is known in advance then skip overload resolution,
+ * and conditions known to be booleans are not checked when they run.
+ * @param ab the libabacus instance to configure.
+ * @param enabled whether functions should be checked.
+ */
+void libab_set_static_checks(libab* ab, int enabled);
 /**
  * Executes the given string of code.
  * @param ab the libabacus instance to use for executing code.
@@ -275,6 +535,41 @@ libab_result libab_call_function(libab* ab, const char* function,
  * @return the result of the computation.
  */
 libab_result libab_run_scoped(libab* ab, const char* string, libab_ref* scope, libab_ref* value);
+/**
+ * Parses and compiles the given string once, so that it can be run
+ * many times without being parsed again. References to the given
+ * variables are resolved ahead of time, and their values are
+ * given every time the expression is run.
+ * @param ab the libabacus instance to use to compile the string.
+ * @param string the string to compile.
+ * @param names the names of the variables to bind.
+ * @param count the number of variables to bind.
+ * @param into the prepared expression to initialize, which
+ * needs no freeing if the preparation fails.
+ * @return the result of the preparation.
+ */
+libab_result libab_prepare(libab* ab, const char* string, const char** names,
+                           size_t count, libab_prepared* into);
+/**
+ * Runs a prepared expression in the given scope. If functions
+ * defined by a previous run still refer to its bindings, the
+ * expression runs with new bindings, leaving theirs unchanged.
+ * @param ab the libabacus instance the expression was prepared with.
+ * @param prepared the expression to run.
+ * @param scope the scope to run the expression in.
+ * @param values the values of the bound variables, in the order
+ * their names were given in.
+ * @param value the reference into which to store the output.
+ * @return the result of the execution.
+ */
+libab_result libab_run_prepared(libab* ab, libab_prepared* prepared,
+                                libab_ref* scope, libab_ref* values,
+                                libab_ref* value);
+/**
+ * Releases the resources of a prepared expression.
+ * @param prepared the expression to free.
+ */
+void libab_prepared_free(libab_prepared* prepared);
 /**
  * Calls a tree in a given scope.
  * @param ab the libabacus instance to use to call the tree.
@@ -297,6 +592,82 @@ libab_result libab_call_function_scoped(libab* ab, const char* function, libab_r
                                        libab_ref* into,
                                        size_t param_count, ...);
 
+/**
+ * Looks up a function by name, so that it can be called
+ * through the handle without being looked up again.
+ * The handle keeps calling the value the name had at the
+ * time of the lookup, even if the name is later redefined.
+ * @param ab the libabacus instance to use to look up the function.
+ * @param function the name of the function to look up.
+ * @param into the handle to initialize, which needs no
+ * freeing if the lookup fails.
+ * @return the result of the lookup.
+ */
+libab_result libab_lookup_function(libab* ab, const char* function,
+                                   libab_function_handle* into);
+/**
+ * Looks up a function by name in the given scope.
+ * @param ab the libabacus instance to use to look up the function.
+ * @param function the name of the function to look up.
+ * @param scope the scope to search, in which calls are also performed.
+ * @param into the handle to initialize, which needs no
+ * freeing if the lookup fails.
+ * @return the result of the lookup.
+ */
+libab_result libab_lookup_function_scoped(libab* ab, const char* function,
+                                          libab_ref* scope,
+                                          libab_function_handle* into);
+/**
+ * Narrows a handle to the single overload that accepts parameters
+ * of the given types, so that later calls skip overload resolution.
+ * Calls with parameters of other types are then rejected.
+ * @param ab the libabacus instance the handle belongs to.
+ * @param handle the handle to narrow.
+ * @param params example parameters, whose types select the overload.
+ * @param param_count the number of parameters.
+ * @return the result of the selection, which leaves the handle
+ * unchanged if it fails.
+ */
+libab_result libab_select_overload(libab* ab, libab_function_handle* handle,
+                                   libab_ref* params, size_t param_count);
+/**
+ * Calls a function through a handle. The parameters are passed
+ * as they are, without being copied into a separate vector.
+ * @param ab the libabacus instance to use to call the function.
+ * @param handle the handle of the function to call.
+ * @param into the reference into which to store the result.
+ * @param params the parameters to pass to the function.
+ * @param param_count the number of parameters.
+ * @return the result of the call.
+ */
+libab_result libab_call_handle(libab* ab, libab_function_handle* handle,
+                               libab_ref* into, libab_ref* params,
+                               size_t param_count);
+/**
+ * Releases the resources of a function handle.
+ * @param handle the handle to free.
+ */
+void libab_function_handle_free(libab_function_handle* handle);
+
+/**
+ * Runs a full garbage collection cycle, releasing all the containers
+ * that are only reachable through reference cycles.
+ * @param ab the libabacus instance whose containers to collect.
+ */
+void libab_gc_collect(libab* ab);
+/**
+ * Runs a garbage collection cycle on the young containers only,
+ * moving the containers that survive it to the old list.
+ * @param ab the libabacus instance whose containers to collect.
+ */
+void libab_gc_collect_young(libab* ab);
+/**
+ * Notifies the garbage collector that a container has been allocated,
+ * running a collection cycle if the allocation threshold has been reached.
+ * @param ab the libabacus instance the container belongs to.
+ */
+void libab_gc_allocated(libab* ab);
+
 /**
  * Releases all the resources allocated by libabacus.
  * @param ab the libabacus instance to release.
@@ -0,0 +1,134 @@
+#ifndef LIBABACUS_PARSE_CACHE_H
+#define LIBABACUS_PARSE_CACHE_H
+
+#include "refcount.h"
+#include "result.h"
+#include <stdlib.h>
+
+/**
+ * A parse tree cached under the source text it was parsed from.
+ */
+struct libab_parse_cache_entry_s {
+    /**
+     * The source text the tree was parsed from.
+     */
+    char* source;
+    /**
+     * The hash of the source text.
+     */
+    unsigned long hash;
+    /**
+     * The generation of the instance's syntax the tree was parsed with.
+     */
+    size_t generation;
+    /**
+     * The cached parse tree.
+     */
+    libab_ref tree;
+    /**
+     * The next entry in the same bucket.
+     */
+    struct libab_parse_cache_entry_s* chain;
+    /**
+     * The entry that was used more recently than this one.
+     */
+    struct libab_parse_cache_entry_s* prev;
+    /**
+     * The entry that was used less recently than this one.
+     */
+    struct libab_parse_cache_entry_s* next;
+};
+
+/**
+ * A bounded cache of parse trees, keyed by their source text,
+ * which discards the least recently used tree when it is full.
+ */
+struct libab_parse_cache_s {
+    /**
+     * The hash table of entries, or NULL if the cache is disabled.
+     */
+    struct libab_parse_cache_entry_s** buckets;
+    /**
+     * The number of buckets, which is always a power of two.
+     */
+    size_t bucket_count;
+    /**
+     * The number of cached trees.
+     */
+    size_t size;
+    /**
+     * The maximum number of cached trees. A value of 0
+     * disables the cache.
+     */
+    size_t capacity;
+    /**
+     * The most recently used entry.
+     */
+    struct libab_parse_cache_entry_s* head;
+    /**
+     * The least recently used entry.
+     */
+    struct libab_parse_cache_entry_s* tail;
+    /**
+     * The number of searches that found a tree.
+     */
+    size_t hits;
+    /**
+     * The number of searches that found no tree.
+     */
+    size_t misses;
+};
+
+typedef struct libab_parse_cache_entry_s libab_parse_cache_entry;
+typedef struct libab_parse_cache_s libab_parse_cache;
+
+/**
+ * Initializes a disabled parse cache.
+ * @param cache the cache to initialize.
+ */
+void libab_parse_cache_init(libab_parse_cache* cache);
+/**
+ * Changes the maximum number of trees the cache holds,
+ * discarding the least recently used ones if there are too many.
+ * @param cache the cache to resize.
+ * @param capacity the new capacity, or 0 to disable the cache.
+ * @return the result of the operation.
+ */
+libab_result libab_parse_cache_resize(libab_parse_cache* cache,
+                                      size_t capacity);
+/**
+ * Finds the tree parsed from the given source text,
+ * marking it as the most recently used. A tree parsed with
+ * another generation of the syntax is discarded instead.
+ * @param cache the cache to search.
+ * @param source the source text to search for.
+ * @param generation the current generation of the syntax.
+ * @param into the reference to store the tree into, which
+ * is a null reference if the tree is not cached.
+ */
+void libab_parse_cache_find(libab_parse_cache* cache, const char* source,
+                            size_t generation, libab_ref* into);
+/**
+ * Stores the tree parsed from the given source text into the cache.
+ * This does nothing if the cache is disabled.
+ * @param cache the cache to store the tree into.
+ * @param source the source text the tree was parsed from.
+ * @param generation the generation of the syntax the tree was parsed with.
+ * @param tree the reference to the tree.
+ * @return the result of the operation.
+ */
+libab_result libab_parse_cache_put(libab_parse_cache* cache,
+                                   const char* source, size_t generation,
+                                   libab_ref* tree);
+/**
+ * Discards all trees in the cache.
+ * @param cache the cache to clear.
+ */
+void libab_parse_cache_clear(libab_parse_cache* cache);
+/**
+ * Frees the given cache.
+ * @param cache the cache to free.
+ */
+void libab_parse_cache_free(libab_parse_cache* cache);
+
+#endif
@@ -8,6 +8,7 @@
 #define LIBABACUS_TYPE_F_PARENT (1)
 #define LIBABACUS_TYPE_F_PLACE (1 << 1)
 #define LIBABACUS_TYPE_F_RESOLVED (1 << 2)
+#define LIBABACUS_TYPE_F_INTERNED (1 << 3)
 
 /**
  * A type, either parsed or resolved.
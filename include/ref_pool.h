@@ -0,0 +1,112 @@
+#ifndef LIBABACUS_REF_POOL_H
+#define LIBABACUS_REF_POOL_H
+
+#include "refcount.h"
+#include "result.h"
+#include "value.h"
+#include <stdlib.h>
+
+#define LIBABACUS_REF_POOL_PAGE_SIZE 64
+
+/**
+ * A page of reference counts, allocated as a single block.
+ */
+struct libab_ref_pool_page_s {
+    /**
+     * The next page in the pool.
+     */
+    struct libab_ref_pool_page_s* next;
+    /**
+     * The reference counts stored in this page.
+     */
+    struct libab_ref_count_s counts[LIBABACUS_REF_POOL_PAGE_SIZE];
+};
+
+/**
+ * A pool of fixed-size reference counts, used to
+ * avoid calling malloc and free for every reference.
+ */
+struct libab_ref_pool_s {
+    /**
+     * The pages allocated by this pool.
+     */
+    struct libab_ref_pool_page_s* pages;
+    /**
+     * The list of unused reference counts, linked
+     * through their next pointers.
+     */
+    struct libab_ref_count_s* free_list;
+    /**
+     * The list of unused inline value allocations,
+     * linked through their blocks.
+     */
+    struct libab_ref_block_s* free_blocks;
+    /**
+     * The number of pages allocated by this pool.
+     */
+    size_t page_count;
+    /**
+     * The number of reference counts and inline values currently in use.
+     */
+    size_t used;
+    /**
+     * The maximum number of pages this pool can allocate
+     * before falling back to malloc. A value of 0 means no limit.
+     */
+    size_t max_pages;
+    /**
+     * Whether the owner of the pool has released it. A released
+     * pool frees itself once its last reference count is returned.
+     */
+    int released;
+};
+
+typedef struct libab_ref_pool_page_s libab_ref_pool_page;
+typedef struct libab_ref_pool_s libab_ref_pool;
+
+/**
+ * Allocates a new, empty pool on the heap.
+ * @param into the pointer into which to store the new pool.
+ * @return the result of the allocation.
+ */
+libab_result libab_ref_pool_create(libab_ref_pool** into);
+/**
+ * Takes a reference count from the pool, allocating a new page if necessary.
+ * @param pool the pool to allocate from.
+ * @return the reference count, or NULL if the pool is full.
+ */
+libab_ref_count* libab_ref_pool_alloc(libab_ref_pool* pool);
+/**
+ * Returns a reference count to the pool it was allocated from.
+ * @param pool the pool to return the reference count to.
+ * @param count the reference count to return.
+ */
+void libab_ref_pool_free(libab_ref_pool* pool, libab_ref_count* count);
+/**
+ * Takes an inline value allocation from the pool, reusing
+ * a previously released one if possible.
+ * @param pool the pool to allocate from.
+ * @return the allocation, or NULL if it could not be made.
+ */
+libab_value_inline* libab_ref_pool_alloc_value(libab_ref_pool* pool);
+/**
+ * Returns the block of an inline value allocation to the pool.
+ * @param pool the pool to return the block to.
+ * @param block the block to return.
+ */
+void libab_ref_pool_free_block(libab_ref_pool* pool, libab_ref_block* block);
+/**
+ * Gets the number of reference counts the pool can hold
+ * without allocating more pages.
+ * @param pool the pool to examine.
+ * @return the capacity of the pool.
+ */
+size_t libab_ref_pool_capacity(libab_ref_pool* pool);
+/**
+ * Releases the pool. The memory of the pool is freed as soon as
+ * all the reference counts allocated from it are returned.
+ * @param pool the pool to release.
+ */
+void libab_ref_pool_release(libab_ref_pool* pool);
+
+#endif
@@ -4,6 +4,30 @@
 #include "result.h"
 #include "gc_functions.h"
 
+struct libab_ref_pool_s;
+
+/**
+ * A block of memory that holds several reference counts
+ * alongside their data. The block is freed once
+ * all the reference counts inside it are released.
+ */
+struct libab_ref_block_s {
+    /**
+     * The number of reference counts in this
+     * block that haven't been released yet.
+     */
+    int counts;
+    /**
+     * The pool this block should be returned to once
+     * it's no longer used, or NULL if it should be freed.
+     */
+    struct libab_ref_pool_s* pool;
+    /**
+     * The next unused block in the pool.
+     */
+    struct libab_ref_block_s* next;
+};
+
 /**
  * A struct for holding
  * the number of references
@@ -35,6 +59,11 @@ struct libab_ref_count_s {
      * This is used for garbage collection.
      */
     int gc;
+    /**
+     * The instance that owns this container, or NULL
+     * if it is not tracked by the garbage collector.
+     */
+    void* owner;
     /**
      * Previous pointer for garbage collection
      * linked list.
@@ -50,6 +79,16 @@ struct libab_ref_count_s {
      * used by GC.
      */
     libab_visit_function_ptr visit_children;
+    /**
+     * The pool from which this reference count was allocated,
+     * or NULL if it was allocated using malloc.
+     */
+    struct libab_ref_pool_s* pool;
+    /**
+     * The block that contains this reference count,
+     * or NULL if it was allocated on its own.
+     */
+    struct libab_ref_block_s* block;
 };
 
 /**
@@ -73,6 +112,7 @@ struct libab_ref_s {
 
 typedef struct libab_ref_s libab_ref;
 typedef struct libab_ref_count_s libab_ref_count;
+typedef struct libab_ref_block_s libab_ref_block;
 
 /**
  * Creates a new referene, using the given data and free function.
@@ -84,6 +124,33 @@ typedef struct libab_ref_count_s libab_ref_count;
  */
 libab_result libab_ref_new(libab_ref* ref, void* data,
                            void (*free_func)(void* data));
+/**
+ * Creates a new reference, allocating its reference count from the given
+ * pool, and falling back to malloc if the pool is NULL or full.
+ * @param ref the reference to initialize with the given data.
+ * @param data the data to reference count.
+ * @param free_func the function to use to realease the data when refcount
+ * reaches 0.
+ * @param pool the pool to allocate the reference count from.
+ * @return the result of the construction of the reference.
+ */
+libab_result libab_ref_new_pooled(libab_ref* ref, void* data,
+                                  void (*free_func)(void* data),
+                                  struct libab_ref_pool_s* pool);
+/**
+ * Creates a new reference using a reference count that
+ * is stored inside the given block. This does not require
+ * a memory allocation.
+ * @param ref the reference to initialize with the given data.
+ * @param count the reference count to initialize.
+ * @param block the block that contains the reference count.
+ * @param data the data to reference count.
+ * @param free_func the function to use to realease the data when refcount
+ * reaches 0.
+ */
+void libab_ref_new_in_block(libab_ref* ref, libab_ref_count* count,
+                            libab_ref_block* block, void* data,
+                            void (*free_func)(void* data));
 /**
  * Creates a reference to NULL. This does
  * not require a memory allocation.
@@ -117,5 +184,11 @@ void libab_ref_data_free(void*);
  * Gets the value of the reference.
  */
 void* libab_ref_get(const libab_ref* ref);
+/**
+ * Releases the memory of a reference count, returning it to
+ * the pool it was allocated from, if any.
+ * @param count the reference count to release.
+ */
+void libab_ref_count_free(libab_ref_count* count);
 
 #endif
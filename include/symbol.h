@@ -0,0 +1,81 @@
+#ifndef LIBABACUS_SYMBOL_H
+#define LIBABACUS_SYMBOL_H
+
+#include "result.h"
+#include <stdlib.h>
+
+#define LIBABACUS_SYMBOLS_INITIAL_SIZE 64
+
+/**
+ * The symbol that no name is ever interned as.
+ */
+#define LIBABACUS_SYMBOL_NONE ((size_t)-1)
+
+/**
+ * A table that assigns every distinct name a small
+ * integer, so that names can be compared and hashed
+ * without looking at their characters.
+ */
+struct libab_symbols_s {
+    /**
+     * The interned names, indexed by their symbol.
+     */
+    char** names;
+    /**
+     * The number of interned names.
+     */
+    size_t size;
+    /**
+     * The number of names that fit into the allocated memory.
+     */
+    size_t capacity;
+    /**
+     * The open addressing hash table mapping names to their
+     * symbols, with LIBABACUS_SYMBOL_NONE marking empty buckets.
+     */
+    size_t* buckets;
+    /**
+     * The number of buckets, which is always a power of two.
+     */
+    size_t bucket_count;
+};
+
+typedef struct libab_symbols_s libab_symbols;
+
+/**
+ * Initializes the given symbol table.
+ * @param symbols the symbol table to initialize.
+ * @return the result of the initialization.
+ */
+libab_result libab_symbols_init(libab_symbols* symbols);
+/**
+ * Gets the symbol of the given name, interning it if
+ * it was not seen before.
+ * @param symbols the symbol table to use.
+ * @param name the name to intern.
+ * @param into the location to store the symbol into.
+ * @return the result of the operation.
+ */
+libab_result libab_symbols_intern(libab_symbols* symbols, const char* name,
+                                  size_t* into);
+/**
+ * Gets the symbol of the given name, without interning it.
+ * @param symbols the symbol table to search.
+ * @param name the name to search for.
+ * @return the symbol, or LIBABACUS_SYMBOL_NONE if the name was never interned.
+ */
+size_t libab_symbols_find(libab_symbols* symbols, const char* name);
+/**
+ * Gets the name of the given symbol.
+ * @param symbols the symbol table the symbol belongs to.
+ * @param symbol the symbol whose name to get.
+ * @return the name, which lives as long as the symbol table.
+ */
+const char* libab_symbols_name(libab_symbols* symbols, size_t symbol);
+/**
+ * Frees the given symbol table.
+ * @param symbols the symbol table to free.
+ */
+void libab_symbols_free(libab_symbols* symbols);
+
+#endif
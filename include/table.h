@@ -3,27 +3,22 @@
 
 #include "basetype.h"
 #include "custom.h"
+#include "libds.h"
 #include "refcount.h"
 #include "result.h"
-#include "trie.h"
+#include "symbol.h"
+#include <stdarg.h>
 
 /**
- * A struct that represents a structure
- * similar to a symbol table. This structure
- * is used to keep track of definitions such
- * as types, functions, and variables in an
- * environment with scopes.
+ * The number of kinds of entries a table can hold
+ * under a single name: values, basetypes, type parameters,
+ * and prefix, infix and postfix operators.
  */
-struct libab_table_s {
-    /**
-     * The "parent" scope of this table.
-     */
-    libab_ref parent;
-    /**
-     * The hash table used to store the data.
-     */
-    libab_trie trie;
-};
+#define LIBABACUS_TABLE_ENTRY_KINDS 6
+/**
+ * The number of slots a table stores inline.
+ */
+#define LIBABACUS_TABLE_FRAME_SIZE 4
 
 /**
  * Enum that represents the type of a table
@@ -54,17 +49,205 @@ struct libab_table_entry_s {
         libab_ref value;
         libab_ref type_param;
     } data_u;
+    /**
+     * The entry of the same kind stored under the same name
+     * after this one, if any.
+     */
+    struct libab_table_entry_s* next;
+};
+
+/**
+ * A single name stored in a table.
+ */
+struct libab_table_bucket_s {
+    /**
+     * The symbol of the name, or LIBABACUS_SYMBOL_NONE
+     * if this bucket is empty.
+     */
+    size_t symbol;
+    /**
+     * The first entry of each kind stored under the name.
+     */
+    struct libab_table_entry_s* entries[LIBABACUS_TABLE_ENTRY_KINDS];
+};
+
+/**
+ * The state shared by all the tables of an instance and its clones,
+ * used to tell when operators resolved by call sites may have changed.
+ */
+struct libab_table_shared_s {
+    /**
+     * Incremented whenever a function is stored, replaced or
+     * overloaded, so that what was checked about the code calling
+     * functions, and the overloads selected by call sites,
+     * are not reused afterwards.
+     */
+    size_t function_epoch;
+    /**
+     * Incremented whenever an operator is added to a table,
+     * or a table holding operators is cleared or freed.
+     */
+    size_t operator_epoch;
+    /**
+     * The id given to the next table that is created.
+     */
+    size_t next_id;
+    /**
+     * For each symbol, whether it names an operator or a function
+     * called by an operator, or NULL if no symbol does.
+     */
+    char* operator_symbols;
+    /**
+     * The number of symbols covered by the operator symbols array.
+     */
+    size_t operator_symbols_size;
+    /**
+     * The number of symbols marked in the operator symbols array.
+     */
+    size_t operator_symbol_count;
+};
+
+/**
+ * A struct that represents a structure
+ * similar to a symbol table. This structure
+ * is used to keep track of definitions such
+ * as types, functions, and variables in an
+ * environment with scopes.
+ */
+struct libab_table_s {
+    /**
+     * The "parent" scope of this table.
+     */
+    libab_ref parent;
+    /**
+     * The symbol table the names of the entries are interned in.
+     */
+    libab_symbols* symbols;
+    /**
+     * The state shared with the other tables of the instance.
+     */
+    struct libab_table_shared_s* shared;
+    /**
+     * The buckets of the open addressing hash table used
+     * to store the data, or NULL if nothing was stored yet.
+     */
+    struct libab_table_bucket_s* buckets;
+    /**
+     * The number of buckets, which is always a power of two.
+     */
+    size_t bucket_count;
+    /**
+     * The number of buckets that hold a name.
+     */
+    size_t size;
+    /**
+     * The displacements of the perfect hash the buckets are laid out
+     * with if the table is frozen, or NULL if they are probed linearly.
+     */
+    size_t* displacements;
+    /**
+     * The number of displacements, which is always a power of two.
+     */
+    size_t displacement_count;
+    /**
+     * The values of the first slots of this table, stored inline
+     * so that small call scopes need no allocations beyond the table.
+     */
+    struct libab_table_entry_s frame[LIBABACUS_TABLE_FRAME_SIZE];
+    /**
+     * The symbols the values in the frame are stored under.
+     */
+    size_t frame_symbols[LIBABACUS_TABLE_FRAME_SIZE];
+    /**
+     * The entries of the slots that didn't fit into the frame,
+     * which are also stored in the hash table.
+     * This is NULL until the frame overflows.
+     */
+    struct libab_table_entry_s** slots;
+    /**
+     * The number of slots in this table, including the frame.
+     */
+    size_t slot_count;
+    /**
+     * The number of overflowing slots that fit into the allocated memory.
+     */
+    size_t slot_capacity;
+    /**
+     * A number that identifies this table, never reused
+     * by any other table.
+     */
+    size_t id;
+    /**
+     * Incremented whenever the table's entries are freed, so
+     * that pointers to them can be checked for validity.
+     */
+    size_t generation;
+    /**
+     * Whether an entry of this table is stored under a symbol
+     * that names an operator or a function called by one.
+     */
+    int operators;
+    /**
+     * The number of operator symbols when the operators
+     * flag was last brought up to date.
+     */
+    size_t operators_checked;
+};
+
+/**
+ * A variable resolved once, so that it can be set many times
+ * without being looked up again.
+ */
+struct libab_table_binding_s {
+    /**
+     * The table the variable was bound in.
+     */
+    libab_ref scope;
+    /**
+     * The symbol of the variable's name.
+     */
+    size_t symbol;
+    /**
+     * The table holding the variable's entry, which is the
+     * scope or one of its parents.
+     */
+    libab_ref owner;
+    /**
+     * The entry holding the variable's value, or NULL
+     * if it has to be resolved again.
+     */
+    struct libab_table_entry_s* entry;
+    /**
+     * The generation of the owner when the entry was resolved.
+     */
+    size_t generation;
 };
 
+typedef struct libab_table_shared_s libab_table_shared;
 typedef struct libab_table_s libab_table;
 typedef enum libab_table_entry_variant_e libab_table_entry_variant;
 typedef struct libab_table_entry_s libab_table_entry;
+typedef struct libab_table_bucket_s libab_table_bucket;
+typedef struct libab_table_binding_s libab_table_binding;
 
+/**
+ * Initializes the state shared between tables.
+ * @param shared the shared state to initialize.
+ */
+void libab_table_shared_init(libab_table_shared* shared);
+/**
+ * Frees the state shared between tables.
+ * @param shared the shared state to free.
+ */
+void libab_table_shared_free(libab_table_shared* shared);
 /**
  * Initializes the given table.
  * @param table the table to initialize.
+ * @param symbols the symbol table to intern names in.
+ * @param shared the state shared with the instance's other tables.
  */
-void libab_table_init(libab_table* table);
+void libab_table_init(libab_table* table, libab_symbols* symbols,
+                      libab_table_shared* shared);
 /**
  * Searches for the given string in the table, comparing
  * values to a given reference as an extra filtering step.
@@ -105,6 +288,16 @@ libab_operator* libab_table_search_operator(libab_table* table,
 libab_table_entry* libab_table_search_entry_operator(libab_table* table,
                                                      const char* string,
                                                      int type);
+/**
+ * Searches for an operator stored under the given symbol in the table.
+ * @param table the table to search.
+ * @param symbol the symbol to search for.
+ * @param type the type of operator to search for (infix, prefix, postfix)
+ * @return the entry, or NULL if it was not found.
+ */
+libab_table_entry* libab_table_search_entry_operator_symbol(libab_table* table,
+                                                            size_t symbol,
+                                                            int type);
 /**
  * Searches for the given basetype in the table, returning a value
  * only if it's a basetype.
@@ -140,6 +333,25 @@ void libab_table_search_value(libab_table* table, const char* string,
  */
 libab_table_entry* libab_table_search_entry_value(libab_table* table,
                                                   const char* string);
+/**
+ * Searches for a value stored under the given symbol in the table.
+ * @param table the table to search.
+ * @param symbol the symbol to search for.
+ * @return the table entry holding the value, or NULL if it was not found.
+ */
+libab_table_entry* libab_table_search_entry_value_symbol(libab_table* table,
+                                                         size_t symbol);
+/**
+ * Searches for a value stored under the given symbol in the table,
+ * also finding the table that holds it.
+ * @param table the table to search.
+ * @param symbol the symbol to search for.
+ * @param owner the location to store the table holding the value into.
+ * @return the table entry holding the value, or NULL if it was not found.
+ */
+libab_table_entry* libab_table_search_entry_value_owner(libab_table* table,
+                                                        size_t symbol,
+                                                        libab_table** owner);
 /**
  * Searches for the given type parameter in the table.
  * @param table the table to search in.
@@ -165,12 +377,99 @@ libab_table_entry* libab_table_search_entry_type_param(libab_table* table,
  */
 libab_result libab_table_put(libab_table* table, const char* string,
                              libab_table_entry* entry);
+/**
+ * Stores the given entry in the table under the given symbol.
+ * @param table the table to store the entry into.
+ * @param symbol the symbol to use as the key.
+ * @param entry the new entry to put into the table.
+ * @return the result of the insertion, which could be LIBAB_MALLOC.
+ */
+libab_result libab_table_put_symbol(libab_table* table, size_t symbol,
+                                    libab_table_entry* entry);
+/**
+ * Stores the given value in the table's next slot, under the given symbol.
+ * The first few slots are stored inline, without allocating an entry.
+ * @param table the table to store the value into.
+ * @param symbol the symbol to use as the key.
+ * @param value the value to store.
+ * @return the result of the insertion, which could be LIBAB_MALLOC.
+ */
+libab_result libab_table_put_slot(libab_table* table, size_t symbol,
+                                  libab_ref* value);
+/**
+ * Calls the given function on every entry stored in the table,
+ * not including the entries of its parents.
+ * @param table the table whose entries to visit.
+ * @param func the function to call, with the entry and the name it is
+ * stored under, which stops the iteration if it does not succeed.
+ * @return the result of the last call to the function.
+ */
+libab_result libab_table_foreach(libab_table* table,
+                                 libab_result (*func)(libab_table_entry*,
+                                                      const char*, va_list),
+                                 ...);
+/**
+ * Compacts the table's buckets into a perfect hash, so that every
+ * lookup in the table examines exactly one bucket. This is meant
+ * for tables that are filled once and then only read; storing
+ * more entries into a frozen table lays it out as usual again.
+ * @param table the table to freeze.
+ * @return the result of the operation.
+ */
+libab_result libab_table_freeze(libab_table* table);
+/**
+ * Gets the entry stored in the given slot of the table.
+ * @param table the table to get the entry from.
+ * @param index the index of the slot.
+ * @return the entry, or NULL if the table has no such slot.
+ */
+libab_table_entry* libab_table_get_slot(libab_table* table, size_t index);
+/**
+ * Checks whether the given ancestor is among the table and its parents,
+ * and none of the tables before it hold an entry stored under the name
+ * of an operator or of a function called by one. Operators resolved in
+ * the ancestor then resolve to the same function in the table.
+ * @param table the table to start from.
+ * @param ancestor the table to look for.
+ * @return whether the ancestor is reached.
+ */
+int libab_table_reaches(libab_table* table, libab_table* ancestor);
 /**
  * Sets the parent of the given table.
  * @param table the table whose parent to set.
  * @param parent a valid reference to a parent table.
  */
 void libab_table_set_parent(libab_table* table, libab_ref* parent);
+/**
+ * Binds a variable, setting it the same way as libab_set_variable:
+ * the closest variable of the given name in the table or its parents
+ * is overwritten, and if there is none, one is created in the table.
+ * The binding keeps setting the same variable even if another variable
+ * of the same name is later created in a closer scope. If the table holding
+ * the variable is cleared, the variable is resolved again on the next set.
+ * @param scope the table to bind the variable in.
+ * @param name the name of the variable.
+ * @param value the value to set the variable to.
+ * @param into the binding to initialize, which needs no
+ * freeing if the operation fails.
+ * @return the result of the operation.
+ */
+libab_result libab_table_bind(libab_ref* scope, const char* name,
+                              libab_ref* value, libab_table_binding* into);
+/**
+ * Sets the variable of the given binding.
+ * @param binding the binding of the variable to set.
+ * @param value the new value of the variable.
+ * @return the result of the operation, which can only fail
+ * if the variable had to be created again.
+ */
+libab_result libab_table_binding_set(libab_table_binding* binding,
+                                     libab_ref* value);
+/**
+ * Frees the given binding.
+ * @param binding the binding to free.
+ */
+void libab_table_binding_free(libab_table_binding* binding);
 /**
  * Clears the table.
  * @param table the table to clear.
@@ -202,6 +501,16 @@ int libab_table_compare_value(const void* left, const void* right);
  * Comparison function used to search the table for a basetype.
  */
 int libab_table_compare_basetype(const void* left, const void* right);
+/**
+ * Replaces the value of the given entry, found through the given table.
+ * Replacing a function with anything, or anything with a function,
+ * advances the function epoch of the table's family.
+ * @param table a table of the family the entry belongs to.
+ * @param entry the value entry whose value to replace.
+ * @param value the new value of the entry.
+ */
+void libab_table_entry_set_value(libab_table* table, libab_table_entry* entry,
+                                 libab_ref* value);
 /**
  * Frees the given table entry.
  * @param entry the entry to free.
@@ -5,6 +5,8 @@
 #include "result.h"
 #include "vec.h"
 
+struct libab_code_s;
+
 /**
  * Enum to represent the variant of a tree node.
  */
@@ -46,6 +48,10 @@ struct libab_tree_s {
      * The string value of this tree, if applicable.
      */
     char* string_value;
+    /**
+     * The symbol the string value is interned as, if applicable.
+     */
+    size_t symbol;
     /**
      * The int value of this tree, if applicable.
      */
@@ -56,6 +62,24 @@ struct libab_tree_s {
      * type does not usually have children.
      */
     vec children;
+    /**
+     * The code this tree was compiled into, cached
+     * after its first run, or NULL.
+     */
+    struct libab_code_s* code;
+    /**
+     * Whether the static checker proved the runtime checks of this
+     * node redundant: for conditionals, that the condition is always
+     * a boolean, and for functions, that their body was checked.
+     * Functions that define other functions are never checked,
+     * and have this set to -1.
+     */
+    int checked;
+    /**
+     * The function epoch in which this node was checked. The proof
+     * only holds until a function is defined or replaced.
+     */
+    size_t checked_epoch;
 
     /**
      * The line on which this tree starts.
@@ -114,6 +138,14 @@ int libab_tree_has_scope(libab_tree_variant var);
  * @return true if the tree node variant contains a vector.
  */
 int libab_tree_has_vector(libab_tree_variant var);
+/**
+ * Determines if running the given tree can add a variable
+ * to the scope it runs in. Function definitions are never
+ * added to the current scope, so only assignments count.
+ * @param tree the tree to check.
+ * @return true if the tree contains an assignment outside a function body.
+ */
+int libab_tree_declares(libab_tree* tree);
 /**
  * Frees the given tree recursively,
  * deleting the children first and the moving on
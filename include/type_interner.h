@@ -0,0 +1,84 @@
+#ifndef LIBABACUS_TYPE_INTERNER_H
+#define LIBABACUS_TYPE_INTERNER_H
+
+#include "parsetype.h"
+#include "refcount.h"
+#include "result.h"
+#include <stdlib.h>
+
+#define LIBABACUS_TYPE_INTERNER_INITIAL_SIZE 32
+
+/**
+ * A canonical type, stored under its hash.
+ */
+struct libab_type_interner_entry_s {
+    /**
+     * The hash of the type, computed from its basetype
+     * and the addresses of its canonical children.
+     */
+    unsigned long hash;
+    /**
+     * The canonical type, or a null reference if
+     * this entry is empty.
+     */
+    libab_ref type;
+};
+
+/**
+ * A table of canonical types, in which every fully resolved type
+ * is stored exactly once. Two canonical types are equal if and
+ * only if they are the same object.
+ */
+struct libab_type_interner_s {
+    /**
+     * The open addressing hash table of canonical types.
+     */
+    struct libab_type_interner_entry_s* entries;
+    /**
+     * The number of entries, which is always a power of two.
+     */
+    size_t capacity;
+    /**
+     * The number of canonical types.
+     */
+    size_t size;
+};
+
+typedef struct libab_type_interner_entry_s libab_type_interner_entry;
+typedef struct libab_type_interner_s libab_type_interner;
+
+/**
+ * Initializes the given interner.
+ * @param interner the interner to initialize.
+ * @return the result of the initialization.
+ */
+libab_result libab_type_interner_init(libab_type_interner* interner);
+/**
+ * Initializes an interner holding the same canonical types as another.
+ * Types interned into either interner afterwards are not shared.
+ * @param interner the interner to initialize.
+ * @param copy_of the interner to copy.
+ * @return the result of the initialization.
+ */
+libab_result libab_type_interner_init_copy(libab_type_interner* interner,
+                                           libab_type_interner* copy_of);
+/**
+ * Gets the canonical type structurally equal to the given type. If there
+ * is none, a copy of the given type with canonical children becomes
+ * canonical, so that the given type itself is never changed. Types that
+ * are not fully resolved have no canonical type, and are returned as is.
+ * A canonical type must never be modified.
+ * @param interner the interner to use.
+ * @param type the type to intern.
+ * @param into the reference to store the canonical type into.
+ * @return the result of the operation.
+ */
+libab_result libab_type_interner_intern(libab_type_interner* interner,
+                                        libab_ref* type, libab_ref* into);
+/**
+ * Frees the given interner, releasing its canonical types.
+ * @param interner the interner to free.
+ */
+void libab_type_interner_free(libab_type_interner* interner);
+
+#endif
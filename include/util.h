@@ -103,6 +103,17 @@ libab_result libab_create_value_ref(libab* ab, libab_ref* into,
  */
 libab_result libab_create_value_raw(libab* ab, libab_ref* into,
                                     void* data, libab_ref* type);
+/**
+ * Allocates a new reference counted value with the given type, copying
+ * the given data into the same allocation as the value and its reference
+ * counts. The type's basetype must declare an inline size.
+ * @param into the reference to store the allocated data into.
+ * @param data the data to copy into the value.
+ * @param type the type to give the value.
+ * @return the result of necessary allocations.
+ */
+libab_result libab_create_value_inline(libab* ab, libab_ref* into,
+                                       const void* data, libab_ref* type);
 /**
  * Overloads a function of the given name.
  * @param table the table to insert the function into.
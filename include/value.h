@@ -3,6 +3,9 @@
 
 #include "refcount.h"
 #include "result.h"
+#include <stdlib.h>
+
+#define LIBABACUS_VALUE_INLINE_SIZE 16
 
 /**
  * A struct that represents a value.
@@ -18,7 +21,48 @@ struct libab_value_s {
     libab_ref data;
 };
 
+/**
+ * Storage for data that is kept inline in a value,
+ * aligned for any of the types it could hold.
+ */
+union libab_value_payload_u {
+    double as_double;
+    long as_long;
+    void* as_pointer;
+    char bytes[LIBABACUS_VALUE_INLINE_SIZE];
+};
+
+/**
+ * A value that is stored in a single allocation together
+ * with its reference count, its data, and the data's reference count.
+ */
+struct libab_value_inline_s {
+    /**
+     * The block that keeps track of the reference counts
+     * that still use this allocation.
+     */
+    libab_ref_block block;
+    /**
+     * The reference count of the value.
+     */
+    libab_ref_count value_count;
+    /**
+     * The reference count of the value's data.
+     */
+    libab_ref_count data_count;
+    /**
+     * The value itself.
+     */
+    struct libab_value_s value;
+    /**
+     * The data of the value.
+     */
+    union libab_value_payload_u payload;
+};
+
 typedef struct libab_value_s libab_value;
+typedef union libab_value_payload_u libab_value_payload;
+typedef struct libab_value_inline_s libab_value_inline;
 
 /**
  * Initializes a new value with the given reference counted data
@@ -40,6 +84,31 @@ void libab_value_init_ref(libab_value* value, libab_ref* data, libab_ref* type);
  */
 libab_result libab_value_init_raw(libab_value* value, void* data,
                                   libab_ref* type);
+/**
+ * Initializes a new value with the given raw allocated data, like
+ * libab_value_init_raw, but allocates the data's reference count from
+ * the given pool.
+ * @param value the value to initialize.
+ * @param data the data this value holds.
+ * @param type the type of this value.
+ * @param pool the pool from which to allocate the reference count.
+ * @return the result of any necessary allocations.
+ */
+libab_result libab_value_init_raw_pooled(libab_value* value, void* data,
+                                         libab_ref* type,
+                                         struct libab_ref_pool_s* pool);
+/**
+ * Initializes a value stored in a single allocation, copying
+ * the given data into it, and creates a reference to it. The pool
+ * of the allocation's block must already be set.
+ * @param block the allocation to initialize.
+ * @param data the data to copy into the value.
+ * @param size the size of the data, at most LIBABACUS_VALUE_INLINE_SIZE.
+ * @param type the type of this value.
+ * @param into the reference into which to store the value.
+ */
+void libab_value_inline_init(libab_value_inline* block, const void* data,
+                             size_t size, libab_ref* type, libab_ref* into);
 /**
  * Frees the given value.
  * @param value the value to free.
@@ -7,5 +7,6 @@ void libab_basetype_init(libab_basetype* basetype, void (*free_function)(void*),
     basetype->params = params;
     basetype->count = n;
     basetype->free_function = free_function;
+    basetype->inline_size = 0;
 }
 void libab_basetype_free(libab_basetype* basetype) {}
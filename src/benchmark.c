@@ -0,0 +1,153 @@
+#include "libabacus.h"
+#include "util.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRY(expression)                                                        \
+    if (result == LIBAB_SUCCESS)                                               \
+        result = expression;
+#define OP_FUNCTION(name, expression)                                          \
+    libab_result name(libab* ab, libab_ref* scope, libab_ref_vec* params,     \
+                      libab_ref* into) {                                       \
+        double left = *((double*)libab_unwrap_param(params, 0));               \
+        double right = *((double*)libab_unwrap_param(params, 1));              \
+        return create_double_value(ab, expression, into);                      \
+    }
+
+#define RUNS 5
+
+/**
+ * A named loop-heavy script to time.
+ */
+struct benchmark {
+    const char* name;
+    const char* code;
+};
+
+static struct benchmark benchmarks[] = {
+    {"counting loop",
+     "i = 0; s = 0; while (i < 100000) { s = s + i; i = i + 1 }; s"},
+    {"nested loops",
+     "i = 0; t = 0; while (i < 300) { j = 0; "
+     "while (j < 300) { t = t + 1; j = j + 1 }; i = i + 1 }; t"},
+    {"calls in a loop",
+     "fun square(x: num): num { x * x }; "
+     "i = 0; s = 0; while (i < 30000) { s = s + square(i); i = i + 1 }; s"},
+    {"recursion",
+     "fun fib(n: num): num { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } }; "
+     "fib(18)"}};
+
+void* impl_parse(const char* string) {
+    double* data = malloc(sizeof(*data));
+    if (data) {
+        *data = strtod(string, NULL);
+    }
+    return data;
+}
+
+void impl_free(void* data) { free(data); }
+
+libab_result create_double_value(libab* ab, double val, libab_ref* into) {
+    libab_ref type_num;
+    libab_result result = LIBAB_SUCCESS;
+    double* data;
+    libab_get_type_num(ab, &type_num);
+    if ((data = malloc(sizeof(*data)))) {
+        *data = val;
+        result = libab_create_value_raw(ab, into, data, &type_num);
+        if (result != LIBAB_SUCCESS) {
+            free(data);
+        }
+    } else {
+        result = LIBAB_MALLOC;
+    }
+    libab_ref_free(&type_num);
+    return result;
+}
+
+libab_result function_less(libab* ab, libab_ref* scope, libab_ref_vec* params,
+                           libab_ref* into) {
+    double left = *((double*)libab_unwrap_param(params, 0));
+    double right = *((double*)libab_unwrap_param(params, 1));
+    libab_get_bool_value(ab, left < right, into);
+    return LIBAB_SUCCESS;
+}
+
+OP_FUNCTION(function_plus, left + right)
+OP_FUNCTION(function_minus, left - right)
+OP_FUNCTION(function_times, left * right)
+
+libab_result register_functions(libab* ab) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_ref arithmetic_type;
+    libab_ref compare_type;
+
+    result = libab_create_type(ab, &arithmetic_type, "(num, num)->num");
+    TRY(libab_create_type(ab, &compare_type, "(num, num)->bool"));
+
+    TRY(libab_register_function(ab, "plus", &arithmetic_type, function_plus));
+    TRY(libab_register_function(ab, "minus", &arithmetic_type, function_minus));
+    TRY(libab_register_function(ab, "times", &arithmetic_type, function_times));
+    TRY(libab_register_function(ab, "less", &compare_type, function_less));
+    TRY(libab_register_operator_infix(ab, "<", 0, -1, "less"));
+    TRY(libab_register_operator_infix(ab, "+", 1, -1, "plus"));
+    TRY(libab_register_operator_infix(ab, "-", 1, -1, "minus"));
+    TRY(libab_register_operator_infix(ab, "*", 2, -1, "times"));
+
+    libab_ref_free(&arithmetic_type);
+    libab_ref_free(&compare_type);
+
+    return result;
+}
+
+/**
+ * Runs the given benchmark several times, each in a fresh instance,
+ * since functions are defined globally, and prints the average time
+ * it took.
+ */
+libab_result run_benchmark(struct benchmark* benchmark) {
+    libab_result result = LIBAB_SUCCESS;
+    libab ab;
+    libab_ref value;
+    clock_t start;
+    clock_t total = 0;
+    int run = 0;
+
+    for (; run < RUNS && result == LIBAB_SUCCESS; run++) {
+        result = libab_init(&ab, impl_parse, impl_free);
+        if (result == LIBAB_SUCCESS) {
+            result = register_functions(&ab);
+            if (result == LIBAB_SUCCESS) {
+                start = clock();
+                result = libab_run(&ab, benchmark->code, &value);
+                total += clock() - start;
+                libab_ref_free(&value);
+            }
+            libab_free(&ab);
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        printf("%-16s %10.2f ms\n", benchmark->name,
+               (double)total * 1000 / CLOCKS_PER_SEC / RUNS);
+    } else {
+        printf("%-16s failed (error code %d)\n", benchmark->name, result);
+    }
+
+    return result;
+}
+
+int main() {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+
+    for (; index < sizeof(benchmarks) / sizeof(*benchmarks) &&
+           result == LIBAB_SUCCESS;
+         index++) {
+        result = run_benchmark(&benchmarks[index]);
+    }
+
+    return result == LIBAB_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
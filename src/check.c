@@ -0,0 +1,541 @@
+#include "check.h"
+#include "code.h"
+#include "util.h"
+#include "value.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct check_state {
+    libab* ab;
+    libab_table* scope;
+    /**
+     * The code of the function's body, whose call sites are seeded.
+     */
+    libab_code* code;
+    /**
+     * The function being checked.
+     */
+    libab_tree* function;
+    /**
+     * The canonical types of the function's parameters,
+     * or NULL for those whose type isn't known.
+     */
+    libab_parsetype** params;
+    /**
+     * The symbols of the variables assigned in the function,
+     * which may hold anything when the function runs.
+     */
+    size_t* assigned;
+    /**
+     * The number of assigned variables.
+     */
+    size_t assigned_count;
+};
+
+/**
+ * Finds the variables assigned in the given tree.
+ * @param tree the tree to search.
+ * @param into the array to store their symbols into, or NULL.
+ * @return the number of assignments.
+ */
+size_t _check_find_assignments(libab_tree* tree, size_t* into) {
+    size_t count = 0;
+    size_t index = 0;
+    libab_tree* left;
+
+    if (tree->variant == TREE_RESERVED_OP &&
+        strcmp(tree->string_value, "=") == 0) {
+        left = vec_index(&tree->children, 0);
+        if (left->variant == TREE_ID) {
+            if (into) {
+                into[count] = left->symbol;
+            }
+            count++;
+        }
+    }
+    if (libab_tree_has_vector(tree->variant)) {
+        for (; index < tree->children.size; index++) {
+            count += _check_find_assignments(vec_index(&tree->children, index),
+                                             into ? into + count : NULL);
+        }
+    }
+
+    return count;
+}
+
+int _check_defines_function(libab_tree* tree) {
+    int defines = tree->variant == TREE_FUN;
+    size_t index = 0;
+
+    if (libab_tree_has_vector(tree->variant)) {
+        for (; index < tree->children.size && !defines; index++) {
+            defines = _check_defines_function(vec_index(&tree->children, index));
+        }
+    }
+
+    return defines;
+}
+
+int _check_assigned(struct check_state* state, size_t symbol) {
+    int assigned = 0;
+    size_t index = 0;
+    for (; index < state->assigned_count && !assigned; index++) {
+        assigned = state->assigned[index] == symbol;
+    }
+    return assigned;
+}
+
+libab_parsetype* _check_param_type(struct check_state* state, size_t symbol) {
+    libab_parsetype* type = NULL;
+    size_t index = 0;
+    for (; index < state->function->children.size - 1; index++) {
+        if (((libab_tree*)vec_index(&state->function->children, index))
+                ->symbol == symbol) {
+            type = state->params[index];
+        }
+    }
+    return type;
+}
+
+/**
+ * Compares the parameter types of a function type to the given
+ * canonical types.
+ * @return 1 if they are the same, 0 if they are not, and -1 if
+ * the function has parameters of types that are not canonical.
+ */
+int _check_compare(libab_parsetype* function_type, libab_parsetype** types,
+                   size_t count) {
+    int matches = 1;
+    size_t index = 0;
+    libab_parsetype* child;
+
+    for (; index < count && matches != -1; index++) {
+        child = libab_ref_get(&function_type->children.data[index]);
+        if (!(child->variant & LIBABACUS_TYPE_F_INTERNED)) {
+            matches = -1;
+        } else if (child != types[index]) {
+            matches = 0;
+        }
+    }
+
+    return matches;
+}
+
+/**
+ * Stores the overload selected for the given call site into its cache.
+ */
+libab_result _check_seed(struct check_state* state, libab_tree* tree,
+                         libab_function_list* list, libab_parsetype** types,
+                         size_t count, size_t index) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_basetype* basetypes[LIBABACUS_CALL_CACHE_PARAMS];
+    libab_instruction* instruction = NULL;
+    size_t pc = 0;
+    int valid = count <= LIBABACUS_CALL_CACHE_PARAMS;
+
+    for (; pc < state->code->size && instruction == NULL; pc++) {
+        if (state->code->instructions[pc].tree == tree &&
+            (state->code->instructions[pc].op == CODE_CALL ||
+             state->code->instructions[pc].op == CODE_TAIL_CALL ||
+             state->code->instructions[pc].op == CODE_OPERATOR)) {
+            instruction = &state->code->instructions[pc];
+        }
+    }
+    for (pc = 0; pc < count && valid; pc++) {
+        valid = !(types[pc]->variant & LIBABACUS_TYPE_F_PARENT);
+        basetypes[pc] = types[pc]->data_u.base;
+    }
+
+    /* Operands of reserved operators have code of their own,
+     * which is not seeded. */
+    if (instruction && valid) {
+        if (instruction->cache == NULL &&
+            (instruction->cache = malloc(sizeof(*instruction->cache)))) {
+            memset(instruction->cache, 0, sizeof(*instruction->cache));
+        }
+        if (instruction->cache) {
+            libab_call_cache_store_types(
+                instruction->cache,
+                libab_get_root(state->ab)->tables.function_epoch, list,
+                basetypes, count, index, 0);
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Selects the overload of the given callee that a call with
+ * parameters of the given types runs, if it is known in advance.
+ * Only the declared return types of built-in functions are
+ * trusted, since those of tree functions are not enforced.
+ * @param state the state of the check.
+ * @param tree the call site.
+ * @param callee the function or function list being called.
+ * @param types the canonical types of the parameters, or NULL.
+ * @param count the number of parameters.
+ * @param into the location to store the type of the result into.
+ * @return the result of the check.
+ */
+libab_result _check_call(struct check_state* state, libab_tree* tree,
+                         libab_ref* callee, libab_parsetype** types,
+                         size_t count, libab_parsetype** into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_value* value = libab_ref_get(callee);
+    libab_parsetype* type = libab_ref_get(&value->type);
+    libab_function_list* list = NULL;
+    libab_parsetype* match = NULL;
+    libab_function* match_function = NULL;
+    libab_parsetype* candidate;
+    libab_value* overload_value;
+    libab_ref overload;
+    size_t list_size = 1;
+    size_t match_index = 0;
+    size_t matches = 0;
+    size_t index = 0;
+    int known = 1;
+    int compared;
+
+    for (; index < count && known; index++) {
+        known = types[index] != NULL;
+    }
+    if (type->data_u.base == libab_get_basetype_function_list(state->ab)) {
+        list = libab_ref_get(&value->data);
+        list_size = libab_function_list_size(list);
+    } else if (type->data_u.base != libab_get_basetype_function(state->ab)) {
+        known = 0;
+    }
+
+    for (index = 0; index < list_size && known; index++) {
+        if (list) {
+            libab_function_list_index(list, index, &overload);
+        } else {
+            libab_ref_copy(callee, &overload);
+        }
+        overload_value = libab_ref_get(&overload);
+        candidate = libab_ref_get(&overload_value->type);
+        if (candidate->children.size == count + 1) {
+            compared = _check_compare(candidate, types, count);
+            if (compared == -1) {
+                known = 0;
+            } else if (compared) {
+                match = candidate;
+                match_function = libab_ref_get(&overload_value->data);
+                match_index = index;
+                matches++;
+            }
+        }
+        libab_ref_free(&overload);
+    }
+
+    *into = NULL;
+    if (known && matches == 1) {
+        if (list) {
+            result = _check_seed(state, tree, list, types, count, match_index);
+        }
+        candidate = libab_ref_get(&match->children.data[count]);
+        if (match_function->behavior.variant == BIMPL_INTERNAL &&
+            (candidate->variant & LIBABACUS_TYPE_F_INTERNED)) {
+            *into = candidate;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Finds the value that the given name refers to in the function's
+ * scope, unless the function may change what it refers to.
+ */
+libab_table_entry* _check_lookup(struct check_state* state, size_t symbol) {
+    libab_table_entry* entry = NULL;
+    if (!_check_assigned(state, symbol)) {
+        entry = libab_table_search_entry_value_symbol(state->scope, symbol);
+    }
+    return entry;
+}
+
+libab_result _check_infer(struct check_state* state, libab_tree* tree,
+                          libab_parsetype** into);
+
+libab_result _check_infer_child(struct check_state* state, libab_tree* tree,
+                                size_t index, libab_parsetype** into) {
+    return _check_infer(state, vec_index(&tree->children, index), into);
+}
+
+libab_result _check_infer_operator(struct check_state* state,
+                                   libab_tree* tree, libab_parsetype** into) {
+    libab_parsetype* types[2];
+    size_t count = tree->variant == TREE_OP ? 2 : 1;
+    libab_table_entry* op_entry;
+    libab_table_entry* entry = NULL;
+    libab_result result = _check_infer_child(state, tree, 0, &types[0]);
+
+    if (result == LIBAB_SUCCESS && count == 2) {
+        result = _check_infer_child(state, tree, 1, &types[1]);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        op_entry = libab_table_search_entry_operator_symbol(
+            state->scope, tree->symbol,
+            tree->variant == TREE_OP ? OPERATOR_INFIX :
+            tree->variant == TREE_PREFIX_OP ? OPERATOR_PREFIX :
+            OPERATOR_POSTFIX);
+        if (op_entry) {
+            entry = _check_lookup(state, op_entry->data_u.op.function_symbol);
+        }
+    }
+
+    if (result == LIBAB_SUCCESS && entry) {
+        result = _check_call(state, tree, &entry->data_u.value, types, count,
+                             into);
+    }
+
+    return result;
+}
+
+libab_result _check_infer_call(struct check_state* state, libab_tree* tree,
+                               libab_parsetype** into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parsetype* types[LIBABACUS_CALL_CACHE_PARAMS];
+    libab_parsetype* type;
+    libab_tree* callee = vec_index(&tree->children, tree->children.size - 1);
+    libab_table_entry* entry = NULL;
+    size_t count = tree->children.size - 1;
+    size_t index = 0;
+
+    for (; index < count && result == LIBAB_SUCCESS; index++) {
+        result = _check_infer_child(state, tree, index, &type);
+        if (index < LIBABACUS_CALL_CACHE_PARAMS) {
+            types[index] = type;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS && count <= LIBABACUS_CALL_CACHE_PARAMS &&
+        callee->variant == TREE_ID &&
+        _check_param_type(state, callee->symbol) == NULL) {
+        entry = _check_lookup(state, callee->symbol);
+    }
+
+    if (result == LIBAB_SUCCESS && entry) {
+        result = _check_call(state, tree, &entry->data_u.value, types, count,
+                             into);
+    }
+
+    return result;
+}
+
+libab_result _check_infer_reserved(struct check_state* state,
+                                   libab_tree* tree, libab_parsetype** into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_tree* right = vec_index(&tree->children, 1);
+    libab_parsetype* type;
+    size_t index = 0;
+
+    if (strcmp(tree->string_value, "=") == 0) {
+        result = _check_infer(state, right, into);
+    } else if (strcmp(tree->string_value, ".") == 0 &&
+               right->variant == TREE_CALL) {
+        result = _check_infer_child(state, tree, 0, &type);
+        for (; index < right->children.size && result == LIBAB_SUCCESS;
+             index++) {
+            result = _check_infer_child(state, right, index, &type);
+        }
+    } else {
+        result = _check_infer_child(state, tree, 0, &type);
+        if (result == LIBAB_SUCCESS) {
+            result = _check_infer(state, right, &type);
+        }
+        if (strcmp(tree->string_value, "&&") == 0 ||
+            strcmp(tree->string_value, "||") == 0) {
+            *into = libab_ref_get(&state->ab->type_bool);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Marks the given conditional if its condition has the given type.
+ */
+void _check_mark(struct check_state* state, libab_tree* tree,
+                 libab_parsetype* condition) {
+    tree->checked = condition == libab_ref_get(&state->ab->type_bool);
+    tree->checked_epoch = libab_get_root(state->ab)->tables.function_epoch;
+}
+
+/**
+ * Infers the type of the given tree, marking the conditionals in it.
+ * @param state the state of the check.
+ * @param tree the tree whose type to infer.
+ * @param into the location to store the canonical type of the tree into,
+ * which is NULL if it is not known.
+ * @return the result of the check.
+ */
+libab_result _check_infer(struct check_state* state, libab_tree* tree,
+                          libab_parsetype** into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parsetype* first;
+    libab_parsetype* second;
+    size_t index = 0;
+
+    *into = NULL;
+    if (tree->variant == TREE_BASE || tree->variant == TREE_BLOCK) {
+        if (tree->children.size == 0) {
+            *into = libab_ref_get(&state->ab->type_unit);
+        }
+        for (; index < tree->children.size && result == LIBAB_SUCCESS;
+             index++) {
+            result = _check_infer_child(state, tree, index, into);
+        }
+    } else if (tree->variant == TREE_NUM) {
+        *into = libab_ref_get(&state->ab->type_num);
+    } else if (tree->variant == TREE_TRUE || tree->variant == TREE_FALSE) {
+        *into = libab_ref_get(&state->ab->type_bool);
+    } else if (tree->variant == TREE_VOID) {
+        *into = libab_ref_get(&state->ab->type_unit);
+    } else if (tree->variant == TREE_ID) {
+        *into = _check_param_type(state, tree->symbol);
+    } else if (tree->variant == TREE_OP || tree->variant == TREE_PREFIX_OP ||
+               tree->variant == TREE_POSTFIX_OP) {
+        result = _check_infer_operator(state, tree, into);
+    } else if (tree->variant == TREE_CALL) {
+        result = _check_infer_call(state, tree, into);
+    } else if (tree->variant == TREE_RESERVED_OP) {
+        result = _check_infer_reserved(state, tree, into);
+    } else if (tree->variant == TREE_IF) {
+        result = _check_infer_child(state, tree, 0, &first);
+        if (result == LIBAB_SUCCESS) {
+            _check_mark(state, tree, first);
+            result = _check_infer_child(state, tree, 1, &first);
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = _check_infer_child(state, tree, 2, &second);
+        }
+        if (result == LIBAB_SUCCESS && first == second) {
+            *into = first;
+        }
+    } else if (tree->variant == TREE_WHILE) {
+        result = _check_infer_child(state, tree, 0, &first);
+        if (result == LIBAB_SUCCESS) {
+            _check_mark(state, tree, first);
+            result = _check_infer_child(state, tree, 1, &first);
+        }
+    } else if (tree->variant == TREE_DOWHILE) {
+        result = _check_infer_child(state, tree, 0, &first);
+        if (result == LIBAB_SUCCESS) {
+            result = _check_infer_child(state, tree, 1, &first);
+        }
+        if (result == LIBAB_SUCCESS) {
+            _check_mark(state, tree, first);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Finds the canonical types of the function's parameters.
+ * Parameters that are assigned to may hold anything.
+ */
+libab_result _check_params(struct check_state* state) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_tree* param;
+    libab_parsetype* type;
+    libab_ref copy;
+    size_t index = 0;
+
+    for (; index < state->function->children.size - 1 &&
+           result == LIBAB_SUCCESS; index++) {
+        param = vec_index(&state->function->children, index);
+        state->params[index] = NULL;
+        if (!_check_assigned(state, param->symbol) &&
+            libab_resolve_parsetype_copy(libab_ref_get(&param->type),
+                                         state->scope,
+                                         &copy) == LIBAB_SUCCESS) {
+            result = libab_intern_type(state->ab, &copy);
+            type = libab_ref_get(&copy);
+            if (result == LIBAB_SUCCESS &&
+                (type->variant & LIBABACUS_TYPE_F_INTERNED)) {
+                /* The interner keeps canonical types alive. */
+                state->params[index] = type;
+            }
+            libab_ref_free(&copy);
+        }
+    }
+
+    return result;
+}
+
+libab_result _check_compile(libab_tree* function, libab_tree* body) {
+    libab_result result = LIBAB_SUCCESS;
+    if (body->code == NULL) {
+        if ((body->code = malloc(sizeof(*body->code)))) {
+            result = libab_code_init_function(body->code, function);
+            if (result != LIBAB_SUCCESS) {
+                free(body->code);
+                body->code = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+    return result;
+}
+
+libab_result libab_check_function(libab* ab, libab_tree* function,
+                                  libab_ref* scope) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_tree* body = vec_index(&function->children,
+                                 function->children.size - 1);
+    libab_parsetype* type;
+    struct check_state state;
+
+    state.ab = ab;
+    state.scope = libab_ref_get(scope);
+    state.function = function;
+    state.params = NULL;
+    state.assigned = NULL;
+    state.assigned_count = _check_find_assignments(body, NULL);
+
+    if (_check_defines_function(body)) {
+        /* Every call would define a function, changing the epoch. */
+        function->checked = -1;
+    } else {
+        result = _check_compile(function, body);
+        if (result == LIBAB_SUCCESS &&
+            ((state.params = malloc(sizeof(*state.params) *
+                                    function->children.size)) == NULL ||
+             (state.assigned = malloc(sizeof(*state.assigned) *
+                                      (state.assigned_count + 1))) == NULL)) {
+            result = LIBAB_MALLOC;
+        }
+
+        if (result == LIBAB_SUCCESS) {
+            state.code = body->code;
+            _check_find_assignments(body, state.assigned);
+            result = _check_params(&state);
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = _check_infer(&state, body, &type);
+        }
+        if (result == LIBAB_SUCCESS) {
+            function->checked = 1;
+            function->checked_epoch = libab_get_root(ab)->tables.function_epoch;
+        }
+
+        free(state.params);
+        free(state.assigned);
+    }
+
+    return result;
+}
+
+int libab_check_needed(libab* ab, libab_tree* function) {
+    return ab->static_checks && function->checked != -1 &&
+           (!function->checked ||
+            function->checked_epoch !=
+                libab_get_root(ab)->tables.function_epoch);
+}
@@ -0,0 +1,529 @@
+#include "code.h"
+#include "parsetype.h"
+#include "value.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LIBABACUS_CODE_INITIAL_CAPACITY 16
+
+struct code_state {
+    libab_code* code;
+    size_t stack;
+    size_t scopes;
+    /**
+     * The function whose body is being compiled, or NULL.
+     */
+    libab_tree* function;
+    /**
+     * The symbols of the variables bound to the slots of the scope
+     * the code starts running in, if no function is being compiled.
+     */
+    const size_t* bound;
+    /**
+     * The number of bound variables.
+     */
+    size_t bound_count;
+    /**
+     * The number of scopes between the scope the code
+     * starts running in and the function's call scope,
+     * or the scope holding the bound variables.
+     */
+    size_t depth;
+    /**
+     * Whether the tree about to be compiled is in tail position,
+     * so that its value is the result of the function body.
+     */
+    int tail;
+};
+
+libab_result _code_init(libab_code* code, libab_tree* tree,
+                        libab_interpreter_scope_mode mode,
+                        libab_tree* function, const size_t* bound,
+                        size_t bound_count, size_t depth, int tail);
+
+libab_result _code_emit(struct code_state* state, libab_opcode op,
+                        libab_tree* tree, size_t arg) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_code* code = state->code;
+    libab_instruction* instruction;
+
+    if (code->size == code->capacity) {
+        libab_instruction* new_instructions =
+            realloc(code->instructions,
+                    sizeof(*new_instructions) * code->capacity * 2);
+        if (new_instructions) {
+            code->instructions = new_instructions;
+            code->capacity *= 2;
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        instruction = &code->instructions[code->size++];
+        instruction->op = op;
+        instruction->tree = tree;
+        instruction->arg = arg;
+        instruction->depth = state->depth + state->scopes;
+        instruction->cache = NULL;
+
+        if (op == CODE_POP || op == CODE_JUMP_FALSE || op == CODE_JUMP_TRUE) {
+            state->stack--;
+        } else if (op == CODE_CALL || op == CODE_TAIL_CALL) {
+            state->stack -= arg;
+        } else if (op == CODE_OPERATOR) {
+            state->stack -= (tree->variant == TREE_OP) ? 1 : 0;
+        } else if (op == CODE_SCOPE_ENTER) {
+            state->scopes++;
+        } else if (op == CODE_SCOPE_EXIT) {
+            state->scopes--;
+        } else if (op != CODE_JUMP) {
+            state->stack++;
+        }
+
+        if (state->stack > code->max_stack) {
+            code->max_stack = state->stack;
+        }
+        if (state->scopes > code->max_scopes) {
+            code->max_scopes = state->scopes;
+        }
+    }
+
+    return result;
+}
+
+void _code_patch(struct code_state* state, size_t jump) {
+    state->code->instructions[jump].arg = state->code->size;
+}
+
+libab_result _code_compile(struct code_state* state, libab_tree* tree,
+                           libab_interpreter_scope_mode mode);
+
+libab_result _code_compile_child(struct code_state* state, libab_tree* tree,
+                                 size_t index,
+                                 libab_interpreter_scope_mode mode) {
+    return _code_compile(state, vec_index(&tree->children, index), mode);
+}
+
+libab_result _code_compile_block(struct code_state* state, libab_tree* tree,
+                                 int tail) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+
+    if (tree->children.size == 0) {
+        result = _code_emit(state, CODE_UNIT, tree, 0);
+    }
+
+    while (result == LIBAB_SUCCESS && index < tree->children.size) {
+        state->tail = tail && index == tree->children.size - 1;
+        result = _code_compile_child(state, tree, index, SCOPE_NORMAL);
+        if (result == LIBAB_SUCCESS && index != tree->children.size - 1) {
+            result = _code_emit(state, CODE_POP, tree, 0);
+        }
+        index++;
+    }
+
+    return result;
+}
+
+libab_result _code_compile_call(struct code_state* state, libab_tree* tree,
+                                int tail) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+
+    for (; index < tree->children.size && result == LIBAB_SUCCESS; index++) {
+        result = _code_compile_child(state, tree, index, SCOPE_NORMAL);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, tail ? CODE_TAIL_CALL : CODE_CALL, tree,
+                            tree->children.size - 1);
+    }
+
+    return result;
+}
+
+libab_result _code_compile_operator(struct code_state* state,
+                                    libab_tree* tree) {
+    libab_result result = _code_compile_child(state, tree, 0, SCOPE_NORMAL);
+
+    if (result == LIBAB_SUCCESS && tree->variant == TREE_OP) {
+        result = _code_compile_child(state, tree, 1, SCOPE_NORMAL);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, CODE_OPERATOR, tree, 0);
+    }
+
+    return result;
+}
+
+libab_result _code_compile_id(struct code_state* state, libab_tree* tree) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+    size_t count = state->function ? state->function->children.size - 1
+                                   : state->bound_count;
+    size_t symbol;
+    int found = 0;
+
+    /* Parameters can't be shadowed from inside the function body, since
+     * assignments update the visible variable instead of creating a new one,
+     * so they always live in the same slot of the call scope. */
+    for (; index < count && !found; index++) {
+        symbol = state->function
+                     ? ((libab_tree*)vec_index(&state->function->children,
+                                               index))->symbol
+                     : state->bound[index];
+        found = symbol == tree->symbol;
+    }
+
+    if (found) {
+        result = _code_emit(state, CODE_LOAD_SLOT, tree, index - 1);
+    } else {
+        result = _code_emit(state, CODE_LOAD, tree, 0);
+    }
+
+    return result;
+}
+
+libab_result _code_precompile(struct code_state* state, libab_tree* tree) {
+    libab_result result = LIBAB_SUCCESS;
+    if (tree->code == NULL) {
+        if ((tree->code = malloc(sizeof(*tree->code)))) {
+            result = _code_init(tree->code, tree, SCOPE_NONE, state->function,
+                                state->bound, state->bound_count,
+                                state->depth + state->scopes, 0);
+            if (result != LIBAB_SUCCESS) {
+                free(tree->code);
+                tree->code = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+    return result;
+}
+
+libab_result _code_compile_reserved(struct code_state* state,
+                                    libab_tree* tree) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_tree* right = vec_index(&tree->children, 1);
+    size_t index = 0;
+
+    /* Reserved operators run their operands in the current scope
+     * themselves, so compile the operands here, while the function
+     * and depth are known. Method calls run the call's children. */
+    if (state->function || state->bound_count) {
+        result = _code_precompile(state, vec_index(&tree->children, 0));
+        if (result == LIBAB_SUCCESS && strcmp(tree->string_value, ".") == 0 &&
+            right->variant == TREE_CALL) {
+            for (; index < right->children.size && result == LIBAB_SUCCESS;
+                 index++) {
+                result = _code_precompile(state,
+                                          vec_index(&right->children, index));
+            }
+        } else if (result == LIBAB_SUCCESS) {
+            result = _code_precompile(state, right);
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, CODE_RESERVED, tree, 0);
+    }
+
+    return result;
+}
+
+libab_result _code_compile_if(struct code_state* state, libab_tree* tree,
+                              int tail) {
+    size_t jump_else;
+    size_t jump_end;
+    libab_result result = _code_compile_child(state, tree, 0, SCOPE_NORMAL);
+
+    if (result == LIBAB_SUCCESS) {
+        jump_else = state->code->size;
+        result = _code_emit(state, CODE_JUMP_FALSE, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        state->tail = tail;
+        result = _code_compile_child(state, tree, 1, SCOPE_FORCE);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        jump_end = state->code->size;
+        result = _code_emit(state, CODE_JUMP, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        /* Only one of the branches leaves a value on the stack. */
+        state->stack--;
+        _code_patch(state, jump_else);
+        state->tail = tail;
+        result = _code_compile_child(state, tree, 2, SCOPE_FORCE);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        _code_patch(state, jump_end);
+    }
+
+    return result;
+}
+
+libab_result _code_compile_while(struct code_state* state, libab_tree* tree) {
+    size_t loop;
+    size_t jump_end;
+    libab_result result = _code_emit(state, CODE_UNIT, tree, 0);
+
+    if (result == LIBAB_SUCCESS) {
+        loop = state->code->size;
+        result = _code_compile_child(state, tree, 0, SCOPE_NORMAL);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        jump_end = state->code->size;
+        result = _code_emit(state, CODE_JUMP_FALSE, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, CODE_POP, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_compile_child(state, tree, 1, SCOPE_FORCE);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, CODE_JUMP, tree, loop);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        _code_patch(state, jump_end);
+    }
+
+    return result;
+}
+
+libab_result _code_compile_dowhile(struct code_state* state,
+                                   libab_tree* tree) {
+    size_t loop;
+    libab_result result = _code_emit(state, CODE_UNIT, tree, 0);
+
+    if (result == LIBAB_SUCCESS) {
+        loop = state->code->size;
+        result = _code_emit(state, CODE_POP, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_compile_child(state, tree, 0, SCOPE_FORCE);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_compile_child(state, tree, 1, SCOPE_NORMAL);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _code_emit(state, CODE_JUMP_TRUE, tree, loop);
+    }
+
+    return result;
+}
+
+libab_result _code_compile(struct code_state* state, libab_tree* tree,
+                           libab_interpreter_scope_mode mode) {
+    libab_result result = LIBAB_SUCCESS;
+    int needs_scope = (mode == SCOPE_FORCE) ||
+        (mode == SCOPE_NORMAL && libab_tree_has_scope(tree->variant));
+    int tail = state->tail;
+
+    /* Only blocks and conditionals pass tail position on to their
+     * children; the scopes they exit afterwards don't change the
+     * value, and are discarded along with the rest of the frame. */
+    state->tail = 0;
+
+    /* Nothing can be added to a scope that no assignment runs in,
+     * so such blocks and bodies reuse the enclosing scope. The base
+     * tree keeps its scope, since hosts may look into it. */
+    if (needs_scope && tree->variant != TREE_BASE) {
+        needs_scope = libab_tree_declares(tree);
+    }
+
+    if (needs_scope) {
+        result = _code_emit(state, CODE_SCOPE_ENTER, tree, 0);
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        return result;
+    }
+
+    if (tree->variant == TREE_BASE || tree->variant == TREE_BLOCK) {
+        result = _code_compile_block(state, tree, tail);
+    } else if (tree->variant == TREE_NUM) {
+        result = _code_emit(state, CODE_NUM, tree, 0);
+    } else if (tree->variant == TREE_ID) {
+        result = _code_compile_id(state, tree);
+    } else if (tree->variant == TREE_CALL) {
+        result = _code_compile_call(state, tree, tail);
+    } else if (tree->variant == TREE_OP || tree->variant == TREE_PREFIX_OP ||
+               tree->variant == TREE_POSTFIX_OP) {
+        result = _code_compile_operator(state, tree);
+    } else if (tree->variant == TREE_FUN) {
+        result = _code_emit(state, CODE_FUN, tree, 0);
+    } else if (tree->variant == TREE_RESERVED_OP) {
+        result = _code_compile_reserved(state, tree);
+    } else if (tree->variant == TREE_TRUE) {
+        result = _code_emit(state, CODE_TRUE, tree, 0);
+    } else if (tree->variant == TREE_FALSE) {
+        result = _code_emit(state, CODE_FALSE, tree, 0);
+    } else if (tree->variant == TREE_IF) {
+        result = _code_compile_if(state, tree, tail);
+    } else if (tree->variant == TREE_WHILE) {
+        result = _code_compile_while(state, tree);
+    } else if (tree->variant == TREE_DOWHILE) {
+        result = _code_compile_dowhile(state, tree);
+    } else {
+        result = _code_emit(state, CODE_UNIT, tree, 0);
+    }
+
+    if (result == LIBAB_SUCCESS && needs_scope) {
+        result = _code_emit(state, CODE_SCOPE_EXIT, tree, 0);
+    }
+
+    return result;
+}
+
+libab_result _code_init(libab_code* code, libab_tree* tree,
+                        libab_interpreter_scope_mode mode,
+                        libab_tree* function, const size_t* bound,
+                        size_t bound_count, size_t depth, int tail) {
+    libab_result result = LIBAB_SUCCESS;
+    struct code_state state;
+
+    code->mode = mode;
+    code->size = 0;
+    code->capacity = LIBABACUS_CODE_INITIAL_CAPACITY;
+    code->max_stack = 0;
+    code->max_scopes = 0;
+    state.code = code;
+    state.stack = 0;
+    state.scopes = 0;
+    state.function = function;
+    state.bound = bound;
+    state.bound_count = bound_count;
+    state.depth = depth;
+    state.tail = tail;
+
+    if ((code->instructions =
+             malloc(sizeof(*code->instructions) * code->capacity))) {
+        result = _code_compile(&state, tree, mode);
+        if (result != LIBAB_SUCCESS) {
+            free(code->instructions);
+        }
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    return result;
+}
+
+libab_result libab_code_init(libab_code* code, libab_tree* tree,
+                             libab_interpreter_scope_mode mode) {
+    return _code_init(code, tree, mode, NULL, NULL, 0, 0, 0);
+}
+
+libab_result libab_code_init_bound(libab_code* code, libab_tree* tree,
+                                   libab_interpreter_scope_mode mode,
+                                   const size_t* bound, size_t count) {
+    return _code_init(code, tree, mode, NULL, bound, count, 0, 0);
+}
+
+libab_result libab_code_init_function(libab_code* code, libab_tree* function) {
+    return _code_init(code,
+                      vec_index(&function->children, function->children.size - 1),
+                      SCOPE_NONE, function, NULL, 0, 0, 1);
+}
+
+/**
+ * Checks whether the basetypes of the given parameters can be used
+ * as a cache key, and if so, stores them into the given array.
+ * @param params the parameters to check.
+ * @param types the array to store the basetypes into, or to compare them to.
+ * @param matching if non-zero, compare the basetypes to the array instead.
+ * @return whether the parameters can be used as a key, or match the array.
+ */
+int _call_cache_key(libab_ref_vec* params, libab_basetype** types,
+                    int matching) {
+    int valid = params->size <= LIBABACUS_CALL_CACHE_PARAMS;
+    size_t index = 0;
+
+    for (; index < params->size && valid; index++) {
+        libab_value* value = libab_ref_get(&params->data[index]);
+        libab_parsetype* type = libab_ref_get(&value->type);
+        if (type->variant & (LIBABACUS_TYPE_F_PARENT | LIBABACUS_TYPE_F_PLACE)) {
+            valid = 0;
+        } else if (matching) {
+            valid = types[index] == type->data_u.base;
+        } else {
+            types[index] = type->data_u.base;
+        }
+    }
+
+    return valid;
+}
+
+libab_call_cache_entry* libab_call_cache_find(libab_call_cache* cache,
+                                              size_t epoch,
+                                              libab_function_list* list,
+                                              libab_ref_vec* params) {
+    libab_call_cache_entry* found = NULL;
+    size_t index = 0;
+
+    for (; index < LIBABACUS_CALL_CACHE_ENTRIES && found == NULL; index++) {
+        libab_call_cache_entry* entry = &cache->entries[index];
+        if (entry->list == list && entry->generation == list->generation &&
+            entry->epoch == epoch &&
+            entry->list_size == libab_function_list_size(list) &&
+            entry->param_count == params->size &&
+            _call_cache_key(params, entry->types, 1)) {
+            found = entry;
+        }
+    }
+
+    return found;
+}
+
+void libab_call_cache_store_types(libab_call_cache* cache, size_t epoch,
+                                  libab_function_list* list,
+                                  libab_basetype** types, size_t count,
+                                  size_t index, int generic) {
+    libab_call_cache_entry* entry = &cache->entries[cache->next];
+
+    memcpy(entry->types, types, sizeof(*types) * count);
+    entry->list = list;
+    entry->generation = list->generation;
+    entry->list_size = libab_function_list_size(list);
+    entry->epoch = epoch;
+    entry->param_count = count;
+    entry->index = index;
+    entry->generic = generic;
+    cache->next = (cache->next + 1) % LIBABACUS_CALL_CACHE_ENTRIES;
+}
+
+void libab_call_cache_store(libab_call_cache* cache, size_t epoch,
+                            libab_function_list* list, libab_ref_vec* params,
+                            size_t index, int generic) {
+    libab_basetype* types[LIBABACUS_CALL_CACHE_PARAMS];
+
+    if (_call_cache_key(params, types, 0)) {
+        libab_call_cache_store_types(cache, epoch, list, types, params->size,
+                                     index, generic);
+    }
+}
+
+void libab_code_free(libab_code* code) {
+    size_t index = 0;
+    for (; index < code->size; index++) {
+        free(code->instructions[index].cache);
+    }
+    free(code->instructions);
+}
@@ -1,5 +1,6 @@
 #include "custom.h"
 #include "util.h"
+#include "value.h"
 
 void libab_behavior_init_internal(libab_behavior* behavior,
                                   libab_function_ptr func) {
@@ -36,6 +37,7 @@ libab_result libab_operator_init(libab_operator* op, libab_operator_variant vari
     op->associativity = associativity;
     result = libab_copy_string(&into, function);
     op->function = into;
+    op->function_symbol = LIBABACUS_SYMBOL_NONE;
     return result;
 }
 
@@ -45,6 +47,8 @@ void libab_operator_free(libab_operator* op) {
 
 libab_result _function_init(libab_function* function, libab_ref* scope) {
     libab_ref_copy(scope, &function->scope);
+    function->specializations = NULL;
+    function->next_specialization = 0;
     return libab_ref_vec_init(&function->params);
 }
 libab_result libab_function_init_internal(libab_function* function,
@@ -71,8 +75,104 @@ libab_result libab_function_init_behavior(libab_function* function,
         libab_behavior_copy(behavior, &function->behavior);
     return result;
 }
+/**
+ * Checks whether the types of the given parameters are canonical, so that
+ * they can identify a specialization, and if so, stores them into the given
+ * array.
+ * @param params the parameters to check.
+ * @param types the array to store the types into, or to compare them to.
+ * @param matching if non-zero, compare the types to the array instead.
+ * @return whether the parameters can be used as a key, or match the array.
+ */
+int _function_specialization_key(libab_ref_vec* params,
+                                 libab_parsetype** types, int matching) {
+    int valid = params->size <= LIBABACUS_SPECIALIZATION_PARAMS;
+    size_t index = 0;
+
+    for (; index < params->size && valid; index++) {
+        libab_value* value = libab_ref_get(&params->data[index]);
+        libab_parsetype* type = libab_ref_get(&value->type);
+        if (!(type->variant & LIBABACUS_TYPE_F_INTERNED)) {
+            valid = 0;
+        } else if (matching) {
+            valid = types[index] == type;
+        } else {
+            types[index] = type;
+        }
+    }
+
+    return valid;
+}
+void _function_free_specialization(libab_specialization* specialization) {
+    if (!specialization->function_type.null) {
+        libab_ref_free(&specialization->function_type);
+        libab_ref_vec_free(&specialization->new_types);
+        libab_ref_trie_free(&specialization->param_map);
+        libab_ref_null(&specialization->function_type);
+    }
+}
+libab_specialization* libab_function_find_specialization(
+    libab_function* function, libab_ref* type, libab_ref_vec* params) {
+    libab_specialization* found = NULL;
+    libab_specialization* specialization;
+    size_t index = 0;
+
+    for (; function->specializations && index < LIBABACUS_SPECIALIZATIONS &&
+           found == NULL;
+         index++) {
+        specialization = &function->specializations[index];
+        if (!specialization->function_type.null &&
+            libab_ref_get(&specialization->function_type) ==
+                libab_ref_get(type) &&
+            specialization->param_count == params->size &&
+            _function_specialization_key(params, specialization->param_types,
+                                         1)) {
+            found = specialization;
+        }
+    }
+
+    return found;
+}
+libab_specialization* libab_function_store_specialization(
+    libab_function* function, libab_ref* type, libab_ref_vec* params,
+    libab_ref_vec* new_types, libab_ref_trie* param_map) {
+    libab_specialization* specialization = NULL;
+    libab_parsetype* types[LIBABACUS_SPECIALIZATION_PARAMS];
+    int valid = _function_specialization_key(params, types, 0);
+    size_t index = 0;
+
+    if (valid && function->specializations == NULL &&
+        (function->specializations =
+             malloc(sizeof(*function->specializations) *
+                    LIBABACUS_SPECIALIZATIONS))) {
+        for (; index < LIBABACUS_SPECIALIZATIONS; index++) {
+            libab_ref_null(&function->specializations[index].function_type);
+        }
+    }
+
+    if (valid && function->specializations) {
+        specialization =
+            &function->specializations[function->next_specialization];
+        function->next_specialization =
+            (function->next_specialization + 1) % LIBABACUS_SPECIALIZATIONS;
+        _function_free_specialization(specialization);
+        libab_ref_copy(type, &specialization->function_type);
+        specialization->param_count = params->size;
+        memcpy(specialization->param_types, types, sizeof(types));
+        specialization->new_types = *new_types;
+        specialization->param_map = *param_map;
+    }
+
+    return specialization;
+}
 void libab_function_free(libab_function* fun) {
+    size_t index = 0;
     libab_behavior_free(&fun->behavior);
     libab_ref_vec_free(&fun->params);
     libab_ref_free(&fun->scope);
+    for (; fun->specializations && index < LIBABACUS_SPECIALIZATIONS;
+         index++) {
+        _function_free_specialization(&fun->specializations[index]);
+    }
+    free(fun->specializations);
 }
@@ -3,6 +3,7 @@
 #include "function_list.h"
 #include "parsetype.h"
 #include "table.h"
+#include "tree.h"
 #include "value.h"
 #include <stdlib.h>
 
@@ -20,6 +21,9 @@ void libab_free_unit(void* unit) {
 void libab_free_bool(void* b) {
     free(b);
 }
+void libab_free_value_inline(void* value) {
+    libab_value_free(value);
+}
 void libab_free_parsetype(void* parsetype) {
     libab_parsetype_free(parsetype);
     free(parsetype);
@@ -28,6 +32,9 @@ void libab_free_table(void* table) {
     libab_table_free(table);
     free(table);
 }
+void libab_free_tree(void* tree) {
+    libab_tree_free_recursive(tree);
+}
 void libab_free_value(void* value) {
     libab_value_free(value);
     free(value);
@@ -1,12 +1,186 @@
 #include "function_list.h"
+#include "parsetype.h"
+#include "value.h"
 
 libab_result libab_function_list_init(libab_function_list* list) {
+    list->generation = 0;
+    list->slots = NULL;
+    list->slot_count = 0;
+    list->indexed = 0;
+    list->polymorphic = NULL;
+    list->polymorphic_count = 0;
+    list->polymorphic_capacity = 0;
     return libab_ref_vec_init(&list->functions);
 }
 
+libab_parsetype* _function_list_type(libab_ref* value) {
+    return libab_ref_get(&((libab_value*)libab_ref_get(value))->type);
+}
+
+unsigned long _function_list_hash_step(unsigned long hash,
+                                       libab_parsetype* type) {
+    return hash * 33 + ((unsigned long)(size_t)type->data_u.base >> 3);
+}
+
+/**
+ * Hashes the arity and parameter basetypes of the given overload.
+ * @param type the type of the overload.
+ * @param hash the location to store the hash into.
+ * @return whether the overload can be indexed.
+ */
+int _function_list_hash_overload(libab_parsetype* type, unsigned long* hash) {
+    size_t arity = type->children.size - 1;
+    size_t index = 0;
+    int valid = 1;
+    libab_parsetype* child;
+
+    *hash = arity;
+    for (; index < arity && valid; index++) {
+        child = libab_ref_get(&type->children.data[index]);
+        valid = !(child->variant & LIBABACUS_TYPE_F_PLACE);
+        if (valid) {
+            *hash = _function_list_hash_step(*hash, child);
+        }
+    }
+
+    return valid;
+}
+
+/**
+ * Hashes the count and basetypes of the given parameters.
+ * @param params the parameters to hash.
+ * @param hash the location to store the hash into.
+ * @return whether the parameters can be used as a key.
+ */
+int _function_list_hash_params(libab_ref_vec* params, unsigned long* hash) {
+    size_t index = 0;
+    int valid = 1;
+    libab_parsetype* type;
+
+    *hash = params->size;
+    for (; index < params->size && valid; index++) {
+        type = _function_list_type(&params->data[index]);
+        valid = !(type->variant & LIBABACUS_TYPE_F_PLACE);
+        if (valid) {
+            *hash = _function_list_hash_step(*hash, type);
+        }
+    }
+
+    return valid;
+}
+
+/**
+ * Checks whether the given indexed overload has the
+ * arity and parameter basetypes of the given parameters.
+ */
+int _function_list_matches(libab_function_list* list, size_t index,
+                           libab_ref_vec* params) {
+    libab_parsetype* type = _function_list_type(&list->functions.data[index]);
+    int matches = type->children.size == params->size + 1;
+    size_t param = 0;
+
+    for (; param < params->size && matches; param++) {
+        matches = ((libab_parsetype*)libab_ref_get(&type->children.data[param]))
+                      ->data_u.base ==
+                  _function_list_type(&params->data[param])->data_u.base;
+    }
+
+    return matches;
+}
+
+void _function_list_place(libab_function_list_slot* slots, size_t slot_count,
+                          unsigned long hash, size_t index) {
+    size_t slot = hash & (slot_count - 1);
+    while (slots[slot].index) {
+        slot = (slot + 1) & (slot_count - 1);
+    }
+    slots[slot].hash = hash;
+    slots[slot].index = index + 1;
+}
+
+libab_result _function_list_grow(libab_function_list* list) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t new_count = list->slot_count ? list->slot_count * 2
+                                        : LIBABACUS_FUNCTION_LIST_INITIAL_SLOTS;
+    libab_function_list_slot* new_slots =
+        malloc(sizeof(*new_slots) * new_count);
+    size_t index = 0;
+
+    if (new_slots) {
+        for (; index < new_count; index++) {
+            new_slots[index].index = 0;
+        }
+        for (index = 0; index < list->slot_count; index++) {
+            if (list->slots[index].index) {
+                _function_list_place(new_slots, new_count,
+                                     list->slots[index].hash,
+                                     list->slots[index].index - 1);
+            }
+        }
+        free(list->slots);
+        list->slots = new_slots;
+        list->slot_count = new_count;
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    return result;
+}
+
+libab_result _function_list_add_polymorphic(libab_function_list* list,
+                                            size_t index) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t new_capacity = list->polymorphic_capacity
+                              ? list->polymorphic_capacity * 2
+                              : LIBABACUS_FUNCTION_LIST_INITIAL_SLOTS;
+    size_t* new_polymorphic;
+
+    if (list->polymorphic_count == list->polymorphic_capacity) {
+        if ((new_polymorphic = realloc(list->polymorphic,
+                                       sizeof(*new_polymorphic) *
+                                           new_capacity))) {
+            list->polymorphic = new_polymorphic;
+            list->polymorphic_capacity = new_capacity;
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        list->polymorphic[list->polymorphic_count++] = index;
+    }
+
+    return result;
+}
+
 libab_result libab_function_list_insert(libab_function_list* list,
                                         libab_ref* function) {
-    return libab_ref_vec_insert(&list->functions, function);
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = list->functions.size;
+    unsigned long hash;
+
+    if (_function_list_hash_overload(_function_list_type(function), &hash)) {
+        if ((list->indexed + 1) * 2 > list->slot_count) {
+            result = _function_list_grow(list);
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_vec_insert(&list->functions, function);
+        }
+        if (result == LIBAB_SUCCESS) {
+            _function_list_place(list->slots, list->slot_count, hash, index);
+            list->indexed++;
+        }
+    } else {
+        result = _function_list_add_polymorphic(list, index);
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_vec_insert(&list->functions, function);
+            if (result != LIBAB_SUCCESS) {
+                list->polymorphic_count--;
+            }
+        }
+    }
+
+    return result;
 }
 
 size_t libab_function_list_size(libab_function_list* list) {
@@ -18,6 +192,55 @@ void libab_function_list_index(libab_function_list* list, size_t index,
     libab_ref_vec_index(&list->functions, index, into);
 }
 
+void libab_function_list_search_init(libab_function_list* list,
+                                     libab_ref_vec* params,
+                                     libab_function_list_search* search) {
+    search->list = list;
+    search->params = params;
+    search->phase = SEARCH_ALL;
+    search->position = 0;
+    if (params && _function_list_hash_params(params, &search->hash)) {
+        search->phase = SEARCH_INDEXED;
+        search->position = list->slot_count ? search->hash & (list->slot_count - 1)
+                                            : 0;
+    }
+}
+
+int libab_function_list_search_next(libab_function_list_search* search,
+                                    size_t* index) {
+    libab_function_list* list = search->list;
+    libab_function_list_slot* slot;
+    int found = 0;
+
+    while (search->phase == SEARCH_INDEXED && !found) {
+        slot = list->slot_count ? &list->slots[search->position] : NULL;
+        if (slot && slot->index) {
+            search->position = (search->position + 1) & (list->slot_count - 1);
+            found = slot->hash == search->hash &&
+                    _function_list_matches(list, slot->index - 1,
+                                           search->params);
+            *index = slot->index - 1;
+        } else {
+            search->phase = SEARCH_POLYMORPHIC;
+            search->position = 0;
+        }
+    }
+
+    if (!found && search->phase == SEARCH_POLYMORPHIC &&
+        search->position < list->polymorphic_count) {
+        *index = list->polymorphic[search->position++];
+        found = 1;
+    } else if (!found && search->phase == SEARCH_ALL &&
+               search->position < list->functions.size) {
+        *index = search->position++;
+        found = 1;
+    }
+
+    return found;
+}
+
 void libab_function_list_free(libab_function_list* list) {
     libab_ref_vec_free(&list->functions);
+    free(list->slots);
+    free(list->polymorphic);
 }
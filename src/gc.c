@@ -4,11 +4,12 @@
 #include <stdio.h>
 #include <memory.h>
 
-void libab_gc_list_init(libab_gc_list* list) {
+void libab_gc_list_init(libab_gc_list* list, void* owner) {
     memset(&list->head_sentinel, 0, sizeof(list->head_sentinel));
     memset(&list->tail_sentinel, 0, sizeof(list->tail_sentinel));
     list->head_sentinel.next = &list->tail_sentinel;
     list->tail_sentinel.prev = &list->head_sentinel;
+    list->owner = owner;
 }
 
 void _gc_count_visit_children(libab_ref_count* ref, libab_visitor_function_ptr func, void* data) {
@@ -39,23 +40,36 @@ void libab_gc_add(libab_ref* ref,
                       libab_visit_function_ptr visit_children,
                       libab_gc_list* list) {
     ref->count->visit_children = visit_children;
+    ref->count->owner = list->owner;
     _libab_gc_list_append(list, ref->count);
 }
 
 void _gc_decrement(libab_ref_count* count, void* data) {
-    if(count->visit_children) count->gc--;
+    /* Containers outside the list being collected have a negative
+     * count, and their references are treated as external. Those of
+     * other instances, such as a clone's prototype, are never touched. */
+    if(count->owner == data && count->gc > 0) count->gc--;
 }
 void _gc_save(libab_ref_count* count, void* data) {
     libab_gc_list* list = data;
-    if(count->visit_children && count->gc >= 0) {
+    if(count->owner == list->owner && count->gc >= 0) {
         count->gc = -1;
         _libab_gc_list_append(list, count);
         _gc_count_visit_children(count, _gc_save, data);
     }
 }
 
-void libab_gc_run(libab_gc_list* list) {
-    libab_gc_list safe;
+void libab_gc_list_merge(libab_gc_list* into, libab_gc_list* from) {
+    if(from->head_sentinel.next != &from->tail_sentinel) {
+        from->head_sentinel.next->prev = into->tail_sentinel.prev;
+        into->tail_sentinel.prev->next = from->head_sentinel.next;
+        from->tail_sentinel.prev->next = &into->tail_sentinel;
+        into->tail_sentinel.prev = from->tail_sentinel.prev;
+        libab_gc_list_init(from, from->owner);
+    }
+}
+
+void _gc_run(libab_gc_list* list, libab_gc_list* safe) {
     libab_ref_count* head;
 
     #define ITERATE(CODE) head = list->head_sentinel.next; \
@@ -65,38 +79,40 @@ void libab_gc_run(libab_gc_list* list) {
         head = head->next; \
     }
 
-    libab_gc_list_init(&safe);
     ITERATE(node->gc = node->weak);
-    ITERATE(_gc_count_visit_children(node, _gc_decrement, NULL));
+    ITERATE(_gc_count_visit_children(node, _gc_decrement, list->owner));
     
     head = list->head_sentinel.next;
     while(head != &list->tail_sentinel) {
         if(head->gc > 0) {
-            _gc_save(head, &safe);
+            _gc_save(head, safe);
             head = &list->head_sentinel;
         }
         head = head->next;
     }
 
+    /* Mark every unreachable node as dead before releasing any data, so that
+     * references between garbage nodes never drive a count back to zero. */
     ITERATE(
         node->weak = -1;
         node->strong = -1;
-        if(node->free_func) node->free_func(node->data);
     );
+    ITERATE(if(node->free_func) node->free_func(node->data));
 
     while ((head = list->head_sentinel.next) != &list->tail_sentinel) {
         head->prev->next = head->next;
         head->next->prev = head->prev;
-        free(head);
+        libab_ref_count_free(head);
     }
+}
 
-    if(safe.head_sentinel.next != &safe.tail_sentinel) {
-        list->head_sentinel.next = safe.head_sentinel.next;
-        list->head_sentinel.next->prev = &list->head_sentinel;
-        list->tail_sentinel.prev = safe.tail_sentinel.prev;
-        list->tail_sentinel.prev->next = &list->tail_sentinel;
-    } else {
-        list->head_sentinel.next = &list->tail_sentinel;
-        list->tail_sentinel.prev = &list->head_sentinel;
-    }
+void libab_gc_run(libab_gc_list* list) {
+    libab_gc_list safe;
+    libab_gc_list_init(&safe, list->owner);
+    _gc_run(list, &safe);
+    libab_gc_list_merge(list, &safe);
+}
+
+void libab_gc_run_promote(libab_gc_list* list, libab_gc_list* into) {
+    _gc_run(list, into);
 }
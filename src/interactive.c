@@ -21,23 +21,17 @@ void* impl_parse(const char* string) {
     return data;
 }
 
+void impl_parse_inline(const char* string, void* into) {
+    *((double*)into) = strtod(string, NULL);
+}
+
 void impl_free(void* data) { free(data); }
 
 libab_result create_double_value(libab* ab, double val, libab_ref* into) {
     libab_ref type_num;
     libab_result result = LIBAB_SUCCESS;
     libab_get_type_num(ab, &type_num);
-    double* new_double = malloc(sizeof(*new_double));
-    if(new_double) {
-        *new_double = val;
-        result = libab_create_value_raw(ab, into, new_double, &type_num);
-        if(result != LIBAB_SUCCESS) {
-            free(new_double);
-        }
-    } else {
-        result = LIBAB_MALLOC;
-        libab_ref_null(into);
-    }
+    result = libab_create_value_inline(ab, into, &val, &type_num);
     libab_ref_free(&type_num);
     return result;
 }
@@ -220,6 +214,7 @@ int main() {
         fprintf(stderr, "Failed to initialize libab.\n");
         exit(1);
     }
+    libab_declare_num_inline(&ab, sizeof(double), impl_parse_inline);
 
     result = register_functions(&ab);
     if(result == LIBAB_SUCCESS) {
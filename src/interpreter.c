@@ -3,6 +3,11 @@
 #include "value.h"
 #include "free_functions.h"
 #include "reserved.h"
+#include "code.h"
+#include "check.h"
+#include <string.h>
+
+#define LIBABACUS_INTERPRETER_LOCAL_STACK 16
 
 libab_result _create_bool_value(libab* ab, int val, libab_ref* into) {
     libab_ref type_bool;
@@ -56,6 +61,20 @@ libab_result libab_interpreter_init(libab_interpreter* intr, libab* ab) {
 struct interpreter_state {
     libab* ab;
     libab_table* base_table;
+    /**
+     * Whether the call being made is a tail call, so that a call
+     * to a tree function is left to the caller of the current body.
+     */
+    int tail_call;
+    /**
+     * The tree function whose call was left to the caller of the
+     * current body, or a null reference if there is none.
+     */
+    libab_ref tail_function;
+    /**
+     * The scope prepared for the tail call, holding its parameters.
+     */
+    libab_ref tail_scope;
 };
 
 void _interpreter_init(struct interpreter_state* state,
@@ -63,17 +82,29 @@ void _interpreter_init(struct interpreter_state* state,
                        libab_ref* scope) {
     state->ab = intr->ab;
     state->base_table = libab_ref_get(scope);
+    state->tail_call = 0;
+    libab_ref_null(&state->tail_function);
+    libab_ref_null(&state->tail_scope);
 }
 
-void _interpreter_free(struct interpreter_state* state) {}
+void _interpreter_free(struct interpreter_state* state) {
+    libab_ref_free(&state->tail_function);
+    libab_ref_free(&state->tail_scope);
+}
 
 libab_result _interpreter_create_num_val(struct interpreter_state* state,
                                          libab_ref* into, const char* from) {
     void* data;
+    libab_value_payload payload;
     libab_result result = LIBAB_SUCCESS;
     libab_ref_null(into);
 
-    if ((data = state->ab->impl.parse_num(from))) {
+    if (state->ab->impl.parse_num_inline) {
+        state->ab->impl.parse_num_inline(from, payload.bytes);
+        libab_ref_free(into);
+        result = libab_create_value_inline(state->ab, into, payload.bytes,
+                                           &state->ab->type_num);
+    } else if ((data = state->ab->impl.parse_num(from))) {
         libab_ref_free(into);
         result = libab_create_value_raw(state->ab, into, data, &state->ab->type_num);
 
@@ -92,6 +123,38 @@ libab_result _interpreter_create_num_val(struct interpreter_state* state,
     return result;
 }
 
+/**
+ * Gets the value of the given number literal, reusing the value
+ * this instance created for the same text before, if any.
+ */
+libab_result _interpreter_get_num_val(struct interpreter_state* state,
+                                      libab_tree* tree, libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab* ab = state->ab;
+
+    libab_ref_trie_get(&ab->literals, tree->string_value, into);
+    if (into->null) {
+        result = _interpreter_create_num_val(state, into, tree->string_value);
+        if (result == LIBAB_SUCCESS &&
+            ab->literal_count == LIBABACUS_LITERALS_MAX) {
+            libab_ref_trie_free(&ab->literals);
+            libab_ref_trie_init(&ab->literals);
+            ab->literal_count = 0;
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_trie_put(&ab->literals, tree->string_value,
+                                        into);
+            ab->literal_count += result == LIBAB_SUCCESS;
+        }
+        if (result != LIBAB_SUCCESS) {
+            libab_ref_free(into);
+            libab_ref_null(into);
+        }
+    }
+
+    return result;
+}
+
 /**
  * Checks if the given type reference contains any placeholder types.
  * @param type the type to check.
@@ -103,7 +166,8 @@ int _interpreter_type_contains_placeholders(libab_ref* type) {
     libab_ref temp_child;
     libab_parsetype* parsetype = libab_ref_get(type);
     placeholder = (parsetype->variant & LIBABACUS_TYPE_F_PLACE) != 0;
-    if (parsetype->variant & LIBABACUS_TYPE_F_PARENT) {
+    if ((parsetype->variant & LIBABACUS_TYPE_F_PARENT) &&
+        !(parsetype->variant & LIBABACUS_TYPE_F_INTERNED)) {
         for (; index < parsetype->children.size && !placeholder; index++) {
             libab_ref_vec_index(&parsetype->children, index, &temp_child);
             placeholder |= _interpreter_type_contains_placeholders(&temp_child);
@@ -157,7 +221,10 @@ libab_result _interpreter_compare_types(libab_ref* left_type,
 
     left_placeholder = left->variant & LIBABACUS_TYPE_F_PLACE;
     right_placeholder = right->variant & LIBABACUS_TYPE_F_PLACE;
-    if (left_placeholder && right_placeholder) {
+    if (left->variant & right->variant & LIBABACUS_TYPE_F_INTERNED) {
+        /* Equal canonical types are the same object. */
+        result = (left == right) ? LIBAB_SUCCESS : LIBAB_MISMATCHED_TYPE;
+    } else if (left_placeholder && right_placeholder) {
         result = LIBAB_AMBIGOUS_TYPE;
     } else {
         if (left_placeholder) {
@@ -237,6 +304,9 @@ libab_result _interpreter_copy_resolved_type(libab_ref* type,
     original = libab_ref_get(type);
     if (original->variant & LIBABACUS_TYPE_F_PLACE) {
         _interpreter_search_type_param(params, scope, original->data_u.name, into);
+    } else if (original->variant & LIBABACUS_TYPE_F_INTERNED) {
+        /* Canonical types have no placeholders to substitute. */
+        libab_ref_copy(type, into);
     } else if ((copy = malloc(sizeof(*copy)))) {
         size_t index = 0;
         copy->variant = original->variant;
@@ -261,13 +331,15 @@ libab_result _interpreter_copy_resolved_type(libab_ref* type,
                 libab_ref_free(&child_copy);
                 libab_ref_free(&temp_child);
             }
+        }
 
-            if (result == LIBAB_SUCCESS) {
-                result = libab_ref_new(into, copy, libab_free_parsetype);
-                if (result != LIBAB_SUCCESS) {
-                    libab_free_parsetype(copy);
-                }
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_new(into, copy, libab_free_parsetype);
+            if (result != LIBAB_SUCCESS) {
+                libab_free_parsetype(copy);
             }
+        } else {
+            free(copy);
         }
     } else {
         result = LIBAB_MALLOC;
@@ -384,8 +456,8 @@ libab_result _interpreter_find_match(libab_function_list* function_values,
                                      libab_ref* match,
                                      int partial) {
     libab_result result = LIBAB_SUCCESS;
-    size_t index = 0;
-    size_t list_size = libab_function_list_size(function_values);
+    size_t index;
+    libab_function_list_search search;
     int found_match = 0;
     libab_ref_trie temp_param_map;
     libab_ref_vec temp_new_types;
@@ -397,7 +469,12 @@ libab_result _interpreter_find_match(libab_function_list* function_values,
     libab_ref_null(match);
     result = libab_ref_vec_init(&temp_new_types);
 
-    for (; index < list_size && result == LIBAB_SUCCESS; index++) {
+    /* Overloads taking other basetypes can't match, so only
+     * the candidates found by the list's index are checked. */
+    libab_function_list_search_init(function_values, partial ? NULL : params,
+                                    &search);
+    while (result == LIBAB_SUCCESS &&
+           libab_function_list_search_next(&search, &index)) {
         libab_function_list_index(function_values, index, &temp_function_value);
         temp_value = libab_ref_get(&temp_function_value);
         temp_function_type = libab_ref_get(&temp_value->type);
@@ -473,7 +550,13 @@ libab_result _interpreter_cast_param(libab* ab, libab_ref* param,
     libab_value* old_value = libab_ref_get(param);
     libab_ref new_value;
 
-    result = libab_create_value_ref(ab, &new_value, &old_value->data, type);
+    if (libab_ref_get(&old_value->type) == libab_ref_get(type)) {
+        /* The value already has the type, and values are
+         * never modified, so it can be passed as it is. */
+        libab_ref_copy(param, &new_value);
+    } else {
+        result = libab_create_value_ref(ab, &new_value, &old_value->data, type);
+    }
     if (result == LIBAB_SUCCESS) {
         result = libab_ref_vec_insert(into, &new_value);
     }
@@ -515,43 +598,128 @@ libab_result _interpreter_run(struct interpreter_state* state, libab_tree* tree,
                               libab_ref* into, libab_ref* scope,
                               libab_interpreter_scope_mode scope_mode);
 
+libab_result _interpreter_foreach_insert_param(const libab_ref* param,
+                                               const char* key,
+                                               va_list args);
+
 /**
- * Calls a tree-based function with the given parameters.
+ * Prepares a call to a tree-based function, compiling its body if
+ * necessary. The parameters, as well as the type parameters, are
+ * stored into a single table created for the call.
  * @param tree the tree function to call.
  * @param the parameters to give to the function.
  * @param scope the scope used for the call.
- * @param into the reference to store the result into;
- * @return the result of the call.
+ * @param param_map the type parameters of the call, or NULL.
+ * @param into the reference to store the table into.
+ * @return the result of the preparation.
  */
-libab_result _interpreter_call_tree(struct interpreter_state* state,
-                                    libab_tree* tree, 
-                                    libab_ref_vec* params,
-                                    libab_ref* scope,
-                                    libab_ref* into) {
-    libab_ref new_scope;
+libab_result _interpreter_enter_tree(struct interpreter_state* state,
+                                     libab_tree* tree,
+                                     libab_ref_vec* params,
+                                     libab_ref* scope,
+                                     libab_ref_trie* param_map,
+                                     libab_ref* into) {
     libab_tree* child;
+    libab_tree* body;
     libab_ref param;
     libab_table* new_scope_raw;
     size_t i;
-    libab_result result = libab_create_table(state->ab, &new_scope, scope);
+    libab_result result = LIBAB_SUCCESS;
+
+    body = vec_index(&tree->children, tree->children.size - 1);
+    if(body->code == NULL) {
+        if((body->code = malloc(sizeof(*body->code)))) {
+            result = libab_code_init_function(body->code, tree);
+            if(result != LIBAB_SUCCESS) {
+                free(body->code);
+                body->code = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if(result == LIBAB_SUCCESS && libab_check_needed(state->ab, tree)) {
+        result = libab_check_function(state->ab, tree, scope);
+    }
 
     if(result == LIBAB_SUCCESS) {
-        new_scope_raw = libab_ref_get(&new_scope);
+        result = libab_create_table(state->ab, into, scope);
+    } else {
+        libab_ref_null(into);
+    }
+
+    if(result == LIBAB_SUCCESS && param_map) {
+        result = libab_ref_trie_foreach(param_map,
+                                        _interpreter_foreach_insert_param,
+                                        into);
+    }
+
+    if(result == LIBAB_SUCCESS) {
+        new_scope_raw = libab_ref_get(into);
         for(i = 0; i < tree->children.size - 1 && result == LIBAB_SUCCESS; i++) {
             child = vec_index(&tree->children, i);
             libab_ref_vec_index(params, i, &param);
-            result = libab_put_table_value(new_scope_raw, child->string_value, &param);
+            result = libab_table_put_slot(new_scope_raw, child->symbol, &param);
             libab_ref_free(&param);
         }
     }
 
-    if(result == LIBAB_SUCCESS) {
-        result = _interpreter_run(state, 
-                vec_index(&tree->children, tree->children.size - 1),
-                into, &new_scope, SCOPE_NONE);
+    if(result != LIBAB_SUCCESS) {
+        libab_ref_free(into);
+        libab_ref_null(into);
+    }
+
+    return result;
+}
+
+/**
+ * Calls a tree-based function with the given parameters. Tail calls
+ * made by its body to other tree functions are made here, one after
+ * the other, instead of by the body's code.
+ * @param tree the tree function to call.
+ * @param the parameters to give to the function.
+ * @param scope the scope used for the call.
+ * @param param_map the type parameters of the call, or NULL.
+ * @param into the reference to store the result into;
+ * @return the result of the call.
+ */
+libab_result _interpreter_call_tree(struct interpreter_state* state,
+                                    libab_tree* tree, 
+                                    libab_ref_vec* params,
+                                    libab_ref* scope,
+                                    libab_ref_trie* param_map,
+                                    libab_ref* into) {
+    libab_ref new_scope;
+    libab_ref function;
+    libab_result result =
+        _interpreter_enter_tree(state, tree, params, scope, param_map,
+                                &new_scope);
+
+    /* The function called last is kept alive while its body runs,
+     * since the tail call that made it may have held its only reference. */
+    libab_ref_null(&function);
+    libab_ref_null(into);
+    while(result == LIBAB_SUCCESS && libab_ref_get(&new_scope)) {
+        libab_ref_free(into);
+        result = _interpreter_run(state,
+                                  vec_index(&tree->children, tree->children.size - 1),
+                                  into, &new_scope, SCOPE_NONE);
+        libab_ref_free(&new_scope);
+        libab_ref_null(&new_scope);
+        if(result == LIBAB_SUCCESS && libab_ref_get(&state->tail_function)) {
+            libab_ref_free(&function);
+            function = state->tail_function;
+            new_scope = state->tail_scope;
+            libab_ref_null(&state->tail_function);
+            libab_ref_null(&state->tail_scope);
+            tree = ((libab_function*)libab_ref_get(&function))
+                       ->behavior.data_u.tree;
+        }
     }
 
     libab_ref_free(&new_scope);
+    libab_ref_free(&function);
 
     return result;
 }
@@ -573,7 +741,7 @@ libab_result _interpreter_call_behavior(struct interpreter_state* state,
     if (behavior->variant == BIMPL_INTERNAL) {
         result = behavior->data_u.internal(state->ab, scope, params, into);
     } else {
-        result = _interpreter_call_tree(state, behavior->data_u.tree, params, scope, into);
+        result = _interpreter_call_tree(state, behavior->data_u.tree, params, scope, NULL, into);
     }
     return result;
 }
@@ -624,7 +792,7 @@ libab_result _interpreter_copy_type_offset(libab_ref* type,
     libab_parsetype* new_type;
     libab_parsetype* copy_of = libab_ref_get(type);
     if((new_type = malloc(sizeof(*new_type)))) {
-        new_type->variant = copy_of->variant;
+        new_type->variant = copy_of->variant & ~LIBABACUS_TYPE_F_INTERNED;
         new_type->data_u = copy_of->data_u;
 
         result = libab_ref_vec_init(&new_type->children);
@@ -678,6 +846,10 @@ libab_result _interpreter_partially_apply(struct interpreter_state* state,
         result = _interpreter_copy_type_offset(&value->type, params->size, &new_type);
     }
 
+    if(result == LIBAB_SUCCESS) {
+        result = libab_intern_type(state->ab, &new_type);
+    }
+
     if(result == LIBAB_SUCCESS) {
         result = libab_create_value_ref(state->ab, into, &new_function, &new_type);
     } else {
@@ -748,23 +920,46 @@ libab_result _interpreter_perform_function_call(struct interpreter_state* state,
     libab_parsetype* function_type;
     libab_ref new_scope;
     size_t new_params;
+    int tail_call = state->tail_call;
 
+    state->tail_call = 0;
     function_value = libab_ref_get(to_call);
     function = libab_ref_get(&function_value->data);
     function_type = libab_ref_get(&function_value->type);
     new_params = params->size - function->params.size;
 
-    result = _interpreter_create_scope(state->ab, &new_scope, &function->scope, param_map);
-
-    if(result != LIBAB_SUCCESS) {
+    if (function_type->children.size - new_params == 1 &&
+        function->behavior.variant == BIMPL_TREE && tail_call) {
+        /* The call is made by the caller of the current body,
+         * once the body's frame is discarded. */
         libab_ref_null(into);
-    } else if (function_type->children.size - new_params == 1) {
-        result = _interpreter_call_behavior(state, &function->behavior, params, &new_scope, into);
+        result = _interpreter_enter_tree(state, function->behavior.data_u.tree,
+                                         params, &function->scope, param_map,
+                                         &state->tail_scope);
+        if (result == LIBAB_SUCCESS) {
+            libab_ref_copy(&function_value->data, &state->tail_function);
+        }
+    } else if (function_type->children.size - new_params == 1 &&
+               function->behavior.variant == BIMPL_TREE) {
+        /* Tree functions store their type parameters in the same
+         * table as their parameters, so no scope is created here. */
+        result = _interpreter_call_tree(state, function->behavior.data_u.tree,
+                                        params, &function->scope, param_map,
+                                        into);
     } else {
-        result = _interpreter_partially_apply(state, to_call, params, &new_scope, into);
-    }
+        result = _interpreter_create_scope(state->ab, &new_scope,
+                                           &function->scope, param_map);
 
-    libab_ref_free(&new_scope);
+        if(result != LIBAB_SUCCESS) {
+            libab_ref_null(into);
+        } else if (function_type->children.size - new_params == 1) {
+            result = _interpreter_call_behavior(state, &function->behavior, params, &new_scope, into);
+        } else {
+            result = _interpreter_partially_apply(state, to_call, params, &new_scope, into);
+        }
+
+        libab_ref_free(&new_scope);
+    }
 
     return result;
 }
@@ -805,30 +1000,184 @@ libab_result _interpreter_cast_and_perform_function_call(
     return result;
 }
 
+/**
+ * Checks the parameters of a call against the type of the function
+ * value being called, reusing the specialization made by an earlier
+ * call with parameters of the same types if there is one. A specialization
+ * may be replaced by any call made after this one, so it has to be used
+ * before the called function runs.
+ * @param to_call the function value being called.
+ * @param params the parameters of the call.
+ * @param new_types the vector to initialize with the new types,
+ * if no specialization is returned.
+ * @param param_map the trie to initialize with the type parameters,
+ * if no specialization is returned.
+ * @param into the location to store the specialization into, or NULL.
+ * @return the result of the check.
+ */
+libab_result _interpreter_specialize(libab_ref* to_call,
+                                     libab_ref_vec* params,
+                                     libab_ref_vec* new_types,
+                                     libab_ref_trie* param_map,
+                                     libab_specialization** into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_value* function_value = libab_ref_get(to_call);
+    libab_parsetype* function_type = libab_ref_get(&function_value->type);
+    libab_function* function = libab_ref_get(&function_value->data);
+
+    *into = libab_function_find_specialization(function, &function_value->type,
+                                               params);
+    if (*into == NULL) {
+        result = libab_ref_vec_init(new_types);
+        if (result == LIBAB_SUCCESS) {
+            result = _interpreter_check_types(&function_type->children, params,
+                                              new_types, &function->scope,
+                                              param_map);
+            if (result == LIBAB_SUCCESS) {
+                *into = libab_function_store_specialization(
+                    function, &function_value->type, params, new_types,
+                    param_map);
+            } else {
+                libab_ref_vec_free(new_types);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Gets the overload previously selected by a call site, computing
+ * the types that the parameters have to be cast to for it.
+ * Only the selected overload's types are checked, and only if it
+ * has type parameters; otherwise, the parameters keep their types.
+ * @param list the list being called.
+ * @param entry the cache entry that matched the call.
+ * @param params the parameters of the call.
+ * @param new_types the vector to initialize with the new types,
+ * if no specialization is used.
+ * @param param_map the trie to initialize with the type parameters,
+ * if no specialization is used.
+ * @param specialization the location to store the specialization
+ * of the overload into, or NULL.
+ * @param match the reference into which to store the overload.
+ * @return the result of the operation.
+ */
+libab_result _interpreter_cached_match(libab_function_list* list,
+                                       libab_call_cache_entry* entry,
+                                       libab_ref_vec* params,
+                                       libab_ref_vec* new_types,
+                                       libab_ref_trie* param_map,
+                                       libab_specialization** specialization,
+                                       libab_ref* match) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+
+    libab_function_list_index(list, entry->index, match);
+    *specialization = NULL;
+    if (entry->generic) {
+        result = _interpreter_specialize(match, params, new_types, param_map,
+                                         specialization);
+    } else {
+        result = libab_ref_vec_init(new_types);
+        if (result == LIBAB_SUCCESS) {
+            libab_ref_trie_init(param_map);
+            for (; index < params->size && result == LIBAB_SUCCESS; index++) {
+                libab_value* param = libab_ref_get(&params->data[index]);
+                result = libab_ref_vec_insert(new_types, &param->type);
+            }
+            if (result != LIBAB_SUCCESS) {
+                libab_ref_vec_free(new_types);
+                libab_ref_trie_free(param_map);
+            }
+        }
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        libab_ref_free(match);
+        libab_ref_null(match);
+    }
+
+    return result;
+}
+
+/**
+ * Records the overload selected for a call in the call site's cache.
+ * @param state the state used to make the call.
+ * @param cache the cache of the call site.
+ * @param list the list being called.
+ * @param params the parameters of the call.
+ * @param match the selected overload.
+ */
+void _interpreter_cache_match(struct interpreter_state* state,
+                              libab_call_cache* cache,
+                              libab_function_list* list,
+                              libab_ref_vec* params,
+                              libab_ref* match) {
+    libab_value* match_value = libab_ref_get(match);
+    size_t list_size = libab_function_list_size(list);
+    size_t index = 0;
+    int found = 0;
+    libab_ref temp;
+
+    for (; index < list_size && !found; index++) {
+        libab_function_list_index(list, index, &temp);
+        found = libab_ref_get(&temp) == match_value;
+        libab_ref_free(&temp);
+    }
+
+    if (found) {
+        libab_call_cache_store(
+            cache, libab_get_root(state->ab)->tables.function_epoch, list,
+            params, index - 1,
+            _interpreter_type_contains_placeholders(&match_value->type));
+    }
+}
+
 /**
  * Calls a function list with the given parameters.
  * @param state the state to use to call the list.
  * @param list the list to call.
  * @param params the parameters to pass to the function list.
+ * @param cache the cache of the call site, or NULL.
  * @param into the reference into which to store the result of the call.
  * @return the result of the call.
  */
 libab_result _interpreter_call_function_list(struct interpreter_state* state,
                                              libab_function_list* list,
                                              libab_ref_vec* params,
+                                             libab_call_cache* cache,
                                              libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
     libab_ref_vec new_types;
     libab_ref to_call;
     libab_ref_trie param_map;
+    libab_call_cache_entry* entry = NULL;
+    libab_specialization* specialization = NULL;
     libab_ref_null(into);
 
-    result =
-        _interpreter_find_match(list, params, &new_types, &param_map, &to_call, 0);
-    if (result == LIBAB_SUCCESS) {
-        if (libab_ref_get(&to_call) == NULL) {
-            result = _interpreter_find_match(list, params, &new_types, &param_map,
-                                             &to_call, 1);
+    if (cache) {
+        entry = libab_call_cache_find(
+            cache, libab_get_root(state->ab)->tables.function_epoch, list,
+            params);
+    }
+
+    if (entry) {
+        result = _interpreter_cached_match(list, entry, params, &new_types,
+                                           &param_map, &specialization,
+                                           &to_call);
+    } else {
+        result = _interpreter_find_match(list, params, &new_types, &param_map,
+                                         &to_call, 0);
+        if (result == LIBAB_SUCCESS) {
+            if (libab_ref_get(&to_call) == NULL) {
+                result = _interpreter_find_match(list, params, &new_types,
+                                                 &param_map, &to_call, 1);
+            }
+        }
+        if (result == LIBAB_SUCCESS && cache &&
+            libab_ref_get(&to_call) != NULL) {
+            _interpreter_cache_match(state, cache, list, params, &to_call);
         }
     }
 
@@ -836,7 +1185,12 @@ libab_result _interpreter_call_function_list(struct interpreter_state* state,
         result = LIBAB_BAD_CALL;
     }
 
-    if (result == LIBAB_SUCCESS) {
+    if (result == LIBAB_SUCCESS && specialization) {
+        libab_ref_free(into);
+        result = _interpreter_cast_and_perform_function_call(
+            state, &to_call, params, &specialization->new_types,
+            &specialization->param_map, into);
+    } else if (result == LIBAB_SUCCESS) {
         libab_ref_free(into);
         result = _interpreter_cast_and_perform_function_call(state, &to_call, params,
                                                              &new_types, &param_map, into);
@@ -864,27 +1218,21 @@ libab_result _interpreter_call_function(struct interpreter_state* state,
     libab_result result = LIBAB_SUCCESS;
     libab_ref_vec temp_new_types;
     libab_ref_trie param_map;
-    libab_value* function_value;
-    libab_parsetype* function_type;
-    libab_function* function_instance;
+    libab_specialization* specialization;
 
-    function_value = libab_ref_get(function);
-    function_type = libab_ref_get(&function_value->type);
-    function_instance = libab_ref_get(&function_value->data);
     libab_ref_null(into);
-
-    result = libab_ref_vec_init(&temp_new_types);
-    if (result == LIBAB_SUCCESS) {
-        result = _interpreter_check_types(&function_type->children,
-                                          params, &temp_new_types, &function_instance->scope, &param_map);
-
-        if (result == LIBAB_SUCCESS) {
-            libab_ref_free(into);
-            result = _interpreter_cast_and_perform_function_call(
-                state, function, params, &temp_new_types, &param_map, into);
-            libab_ref_trie_free(&param_map);
-        }
-
+    result = _interpreter_specialize(function, params, &temp_new_types,
+                                     &param_map, &specialization);
+    if (result == LIBAB_SUCCESS && specialization) {
+        libab_ref_free(into);
+        result = _interpreter_cast_and_perform_function_call(
+            state, function, params, &specialization->new_types,
+            &specialization->param_map, into);
+    } else if (result == LIBAB_SUCCESS) {
+        libab_ref_free(into);
+        result = _interpreter_cast_and_perform_function_call(
+            state, function, params, &temp_new_types, &param_map, into);
+        libab_ref_trie_free(&param_map);
         libab_ref_vec_free(&temp_new_types);
     }
 
@@ -896,11 +1244,13 @@ libab_result _interpreter_call_function(struct interpreter_state* state,
  * @param state the state in which to run the code.
  * @param value the value which is being called.
  * @param params the parameters given to the value.
+ * @param cache the cache of the call site, or NULL.
  * @param into the reference into which to store the output of the call.
  * @return the result of the call.
  */
 libab_result _interpreter_try_call(struct interpreter_state* state,
                                    libab_ref* value, libab_ref_vec* params,
+                                   libab_call_cache* cache,
                                    libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
     libab_value* callee_value;
@@ -912,7 +1262,7 @@ libab_result _interpreter_try_call(struct interpreter_state* state,
 
     if (callee_basetype == libab_get_basetype_function_list(state->ab)) {
         result = _interpreter_call_function_list(
-            state, libab_ref_get(&callee_value->data), params, into);
+            state, libab_ref_get(&callee_value->data), params, cache, into);
     } else if (callee_basetype == libab_get_basetype_function(state->ab)) {
         result = _interpreter_call_function(state, value, params, into);
     } else {
@@ -933,106 +1283,114 @@ libab_result _interpreter_require_value(libab_ref* scope, const char* name,
     return result;
 }
 
-libab_result _interpreter_call_operator(struct interpreter_state* state,
-                                        libab_operator* to_call,
-                                        libab_ref* into, libab_ref* scope,
-                                        ...) {
-    va_list args;
+libab_result _interpreter_require_symbol(libab_ref* scope, size_t symbol,
+                                         libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
-    libab_ref function_value;
-    libab_ref_vec params;
-    libab_ref temp;
-
-    libab_ref_null(into);
-    libab_ref_null(&function_value);
-    va_start(args, scope);
-    result = libab_ref_vec_init(&params);
-
-    if (result == LIBAB_SUCCESS) {
-        /* Get first parameter. */
-        result =
-            _interpreter_run(state, va_arg(args, libab_tree*), &temp, scope, SCOPE_NORMAL);
-
-        if (result == LIBAB_SUCCESS) {
-            result = libab_ref_vec_insert(&params, &temp);
-        }
-
-        libab_ref_free(&temp);
+    libab_table_entry* entry =
+        libab_table_search_entry_value_symbol(libab_ref_get(scope), symbol);
+    if(entry) {
+        libab_ref_copy(&entry->data_u.value, into);
+    } else {
+        libab_ref_null(into);
+        result = LIBAB_UNEXPECTED;
+    }
+    return result;
+}
 
-        /* If infix, get second parameter. */
-        if (result == LIBAB_SUCCESS && to_call->variant == OPERATOR_INFIX) {
-            result = _interpreter_run(state, va_arg(args, libab_tree*), &temp,
-                                      scope, SCOPE_NORMAL);
+libab_result _interpreter_load_slot(libab_ref* scope,
+                                    libab_instruction* instruction,
+                                    libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table* table = libab_ref_get(scope);
+    libab_table_entry* entry = NULL;
+    size_t depth = instruction->depth;
 
-            if (result == LIBAB_SUCCESS) {
-                result = libab_ref_vec_insert(&params, &temp);
-            }
+    while(table && depth--) {
+        table = libab_ref_get(&table->parent);
+    }
+    if(table) {
+        entry = libab_table_get_slot(table, instruction->arg);
+    }
 
-            libab_ref_free(&temp);
-        }
+    if(entry && entry->variant == ENTRY_VALUE) {
+        libab_ref_copy(&entry->data_u.value, into);
+    } else {
+        result = _interpreter_require_symbol(scope, instruction->tree->symbol,
+                                             into);
+    }
 
-        if(result == LIBAB_SUCCESS) {
-            libab_ref_free(&function_value);
-            result = _interpreter_require_value(scope, to_call->function, &function_value);
-        }
+    return result;
+}
 
-        if(result == LIBAB_SUCCESS) {
-            libab_ref_free(into);
-            result = _interpreter_try_call(state, &function_value, &params, into);
+/**
+ * Finds the function called by the given operator tree, reusing the
+ * resolution stored in the cache while no operator changed and the
+ * table holding the function is still reached from the scope.
+ * @param tree the operator tree.
+ * @param scope the scope in which the operator is called.
+ * @param cache the cache of the call site, or NULL.
+ * @param into the reference into which to store the function.
+ * @return the result of the search.
+ */
+libab_result _interpreter_resolve_operator(libab_tree* tree, libab_ref* scope,
+                                           libab_call_cache* cache,
+                                           libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table* table = libab_ref_get(scope);
+    libab_table_entry* entry = NULL;
+    libab_table_entry* op_entry;
+    libab_table* owner;
+
+    if(cache && cache->function &&
+       cache->operator_epoch == table->shared->operator_epoch &&
+       libab_table_reaches(table, cache->owner) &&
+       cache->owner->id == cache->owner_id &&
+       cache->owner->generation == cache->owner_generation) {
+        entry = cache->function;
+    } else if((op_entry = libab_table_search_entry_operator_symbol(
+                    table, tree->symbol,
+                    tree->variant == TREE_OP ? OPERATOR_INFIX :
+                    tree->variant == TREE_PREFIX_OP ? OPERATOR_PREFIX :
+                    OPERATOR_POSTFIX))) {
+        entry = libab_table_search_entry_value_owner(
+            table, op_entry->data_u.op.function_symbol, &owner);
+        if(cache && entry) {
+            cache->function = entry;
+            cache->owner = owner;
+            cache->owner_id = owner->id;
+            cache->owner_generation = owner->generation;
+            cache->operator_epoch = table->shared->operator_epoch;
         }
+    }
 
-        libab_ref_vec_free(&params);
+    if(entry) {
+        libab_ref_copy(&entry->data_u.value, into);
+    } else {
+        libab_ref_null(into);
+        result = LIBAB_UNEXPECTED;
     }
-    va_end(args);
-    libab_ref_free(&function_value);
 
     return result;
 }
 
-libab_result _interpreter_run_call_node(struct interpreter_state* state,
-                                            libab_tree* tree, libab_ref* into,
-                                            libab_ref* scope) {
+libab_result _interpreter_call_operator(struct interpreter_state* state,
+                                        libab_tree* tree,
+                                        libab_ref_vec* params,
+                                        libab_ref* scope,
+                                        libab_call_cache* cache,
+                                        libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
-    libab_ref param;
-    libab_ref callee;
-    libab_ref_vec params;
-    size_t count = 0;
-    void* child;
-
-    libab_ref_null(&param);
-    result = libab_ref_vec_init(&params);
-    for (; count < tree->children.size - 1 && result == LIBAB_SUCCESS;
-         count++) {
-        libab_ref_free(&param);
-        child = vec_index(&tree->children, count);
-        result = _interpreter_run(state, child, &param, scope, SCOPE_NORMAL);
-
-        if (result == LIBAB_SUCCESS) {
-            result = libab_ref_vec_insert(&params, &param);
-        }
-
-        if (result != LIBAB_SUCCESS) {
-            libab_ref_vec_free(&params);
-        }
-    }
-    libab_ref_free(&param);
+    libab_ref function_value;
 
-    if (result == LIBAB_SUCCESS) {
-        result = _interpreter_run(
-            state, vec_index(&tree->children, tree->children.size - 1), &callee,
-            scope, SCOPE_NORMAL);
-        if (result != LIBAB_SUCCESS) {
-            libab_ref_vec_free(&params);
-        }
-    }
+    libab_ref_null(into);
+    result = _interpreter_resolve_operator(tree, scope, cache, &function_value);
 
-    if (result == LIBAB_SUCCESS) {
-        result = _interpreter_try_call(state, &callee, &params, into);
-        libab_ref_free(&callee);
-        libab_ref_vec_free(&params);
-    } else {
-        libab_ref_null(into);
+    if(result == LIBAB_SUCCESS) {
+        libab_ref_free(into);
+        result = _interpreter_try_call(state, &function_value, params, cache,
+                                       into);
     }
+    libab_ref_free(&function_value);
 
     return result;
 }
@@ -1105,6 +1463,16 @@ libab_result _interpreter_wrap_function_type(
 
     if(result == LIBAB_SUCCESS) {
         result = libab_ref_new(into, type, libab_free_parsetype);
+        if(result != LIBAB_SUCCESS) {
+            libab_free_parsetype(type);
+        }
+    }
+
+    if(result == LIBAB_SUCCESS) {
+        result = libab_intern_type(state->ab, into);
+        if(result != LIBAB_SUCCESS) {
+            libab_ref_free(into);
+        }
     }
 
     if(result != LIBAB_SUCCESS) {
@@ -1144,150 +1512,283 @@ libab_result _interpreter_create_function_value(
 }
 
 libab_result _interpreter_expect_boolean(struct interpreter_state* state,
-                                         libab_tree* tree, int* into,
-                                         libab_ref* scope,
-                                         libab_interpreter_scope_mode mode) {
-    libab_ref output;
-    libab_result result = _interpreter_run(state, tree, &output, scope, mode);
-    libab_value* value;
-    libab_parsetype* type;
-    if(result == LIBAB_SUCCESS) {
-        value = libab_ref_get(&output);
-        type = libab_ref_get(&value->type);
+                                         libab_ref* output, int* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_value* value = libab_ref_get(output);
+    libab_parsetype* type = libab_ref_get(&value->type);
 
-        if(type->data_u.base != libab_get_basetype_bool(state->ab)) {
-            result = LIBAB_BAD_CALL;
+    if(type->data_u.base != libab_get_basetype_bool(state->ab)) {
+        result = LIBAB_BAD_CALL;
+    } else {
+        *into = *((int*) libab_ref_get(&value->data));
+    }
+
+    return result;
+}
+
+libab_result _interpreter_define_function(struct interpreter_state* state,
+                                          libab_tree* tree, libab_ref* scope,
+                                          libab_ref* into) {
+    libab_ref function;
+    libab_result result =
+        _interpreter_create_function_value(state, tree, scope, &function);
+
+    if(result == LIBAB_SUCCESS) {
+        result = libab_overload_function(state->ab, libab_ref_get(scope),
+                tree->string_value, &function);
+        if(result == LIBAB_SUCCESS && libab_check_needed(state->ab, tree)) {
+            result = libab_check_function(state->ab, tree, scope);
+        }
+        if(result != LIBAB_SUCCESS) {
+            libab_ref_free(&function);
+            libab_ref_null(&function);
         }
+    }
+
+    libab_ref_copy(&function, into);
+    libab_ref_free(&function);
 
+    return result;
+}
+
+/**
+ * Moves the given number of values from the top of the stack into
+ * a new vector, preserving their order.
+ * @param stack the stack to take the values from.
+ * @param stack_size the size of the stack, which is decreased.
+ * @param count the number of values to take.
+ * @param into the vector to initialize with the values.
+ * @return the result of the operation.
+ */
+libab_result _interpreter_pop_params(libab_ref* stack, size_t* stack_size,
+                                     size_t count, libab_ref_vec* into) {
+    size_t index = *stack_size - count;
+    libab_result result = libab_ref_vec_init(into);
+
+    for(; index < *stack_size; index++) {
         if(result == LIBAB_SUCCESS) {
-            *into = *((int*) libab_ref_get(&value->data));
+            result = libab_ref_vec_insert(into, &stack[index]);
         }
+        libab_ref_free(&stack[index]);
+    }
+    *stack_size -= count;
+
+    if(result != LIBAB_SUCCESS) {
+        libab_ref_vec_free(into);
     }
-    libab_ref_free(&output);
+
     return result;
 }
 
-libab_result _interpreter_run(struct interpreter_state* state, libab_tree* tree,
-                              libab_ref* into, libab_ref* scope,
-                              libab_interpreter_scope_mode mode) {
-    #define RUN_CHECK(i) _interpreter_expect_boolean(state, \
-        vec_index(&tree->children, i), &value, scope, SCOPE_NORMAL)
+/**
+ * Gets the overload cache of the given call instruction, creating
+ * it if necessary. Calls are still made, only without a cache,
+ * if it can't be allocated.
+ * @param instruction the instruction whose cache to get.
+ * @return the cache, or NULL.
+ */
+libab_call_cache* _interpreter_get_cache(libab_instruction* instruction) {
+    if(instruction->cache == NULL &&
+       (instruction->cache = malloc(sizeof(*instruction->cache)))) {
+        memset(instruction->cache, 0, sizeof(*instruction->cache));
+    }
+    return instruction->cache;
+}
 
+/**
+ * Runs compiled code.
+ * @param state the state to use to run the code.
+ * @param code the code to run.
+ * @param scope the scope in which to run the code.
+ * @param into the reference into which to store the result.
+ * @return the result of the execution.
+ */
+libab_result _interpreter_execute(struct interpreter_state* state,
+                                  libab_code* code, libab_ref* scope,
+                                  libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
-    libab_ref new_scope;
-    int needs_scope = (mode == SCOPE_FORCE) || 
-        (mode == SCOPE_NORMAL && libab_tree_has_scope(tree->variant));
-
-    if (needs_scope) {
-        result = libab_create_table(state->ab, &new_scope, scope);
-        scope = &new_scope;
+    libab_ref local_stack[LIBABACUS_INTERPRETER_LOCAL_STACK];
+    libab_ref local_scopes[LIBABACUS_INTERPRETER_LOCAL_STACK];
+    libab_ref* stack = local_stack;
+    libab_ref* scopes = local_scopes;
+    libab_ref* current_scope = scope;
+    size_t stack_size = 0;
+    size_t scope_count = 0;
+    size_t pc = 0;
+    int tail = 0;
+
+    if(code->max_stack > LIBABACUS_INTERPRETER_LOCAL_STACK &&
+       (stack = malloc(sizeof(*stack) * code->max_stack)) == NULL) {
+        result = LIBAB_MALLOC;
+    }
+    if(code->max_scopes > LIBABACUS_INTERPRETER_LOCAL_STACK &&
+       (scopes = malloc(sizeof(*scopes) * code->max_scopes)) == NULL) {
+        result = LIBAB_MALLOC;
     }
 
-    if (result != LIBAB_SUCCESS) {
-        libab_ref_null(into);
-    } else if (tree->variant == TREE_BASE || tree->variant == TREE_BLOCK) {
-        size_t index = 0;
-        libab_get_unit_value(state->ab, into);
-        while (result == LIBAB_SUCCESS && index < tree->children.size) {
-            libab_ref_free(into);
-            result = _interpreter_run(state, vec_index(&tree->children, index),
-                                      into, scope, SCOPE_NORMAL);
-            index++;
-        }
-    } else if (tree->variant == TREE_NUM) {
-        result = _interpreter_create_num_val(state, into, tree->string_value);
-    } else if (tree->variant == TREE_VOID) {
-        libab_get_unit_value(state->ab, into);
-    } else if (tree->variant == TREE_ID) {
-        result = _interpreter_require_value(scope, tree->string_value, into);
-    } else if (tree->variant == TREE_CALL) {
-        result = _interpreter_run_call_node(state, tree, into, scope);
-    } else if (tree->variant == TREE_OP) {
-        libab_operator* to_call = libab_table_search_operator(
-            libab_ref_get(scope), tree->string_value, OPERATOR_INFIX);
-        result = _interpreter_call_operator(state, to_call, into, scope,
-                                            vec_index(&tree->children, 0),
-                                            vec_index(&tree->children, 1));
-    } else if (tree->variant == TREE_PREFIX_OP) {
-        libab_operator* to_call = libab_table_search_operator(
-            libab_ref_get(scope), tree->string_value, OPERATOR_PREFIX);
-        result = _interpreter_call_operator(state, to_call, into, scope,
-                                            vec_index(&tree->children, 0));
-    } else if (tree->variant == TREE_POSTFIX_OP) {
-        libab_operator* to_call = libab_table_search_operator(
-            libab_ref_get(scope), tree->string_value, OPERATOR_POSTFIX);
-        result = _interpreter_call_operator(state, to_call, into, scope,
-                                            vec_index(&tree->children, 0));
-    } else if (tree->variant == TREE_FUN) {
-        libab_ref function;
-        result = 
-            _interpreter_create_function_value(state, tree, scope, &function);
+    while(result == LIBAB_SUCCESS && pc < code->size) {
+        libab_instruction* instruction = &code->instructions[pc++];
+        libab_tree* tree = instruction->tree;
+        libab_ref_vec params;
+        libab_ref callee;
+        int value;
 
-        if(result == LIBAB_SUCCESS) {
-            result = libab_overload_function(state->ab, libab_ref_get(scope),
-                    tree->string_value, &function);
-            if(result != LIBAB_SUCCESS) {
-                libab_ref_free(&function);
-                libab_ref_null(&function);
+        switch(instruction->op) {
+        case CODE_UNIT:
+            libab_get_unit_value(state->ab, &stack[stack_size++]);
+            break;
+        case CODE_TRUE:
+            libab_get_true_value(state->ab, &stack[stack_size++]);
+            break;
+        case CODE_FALSE:
+            libab_get_false_value(state->ab, &stack[stack_size++]);
+            break;
+        case CODE_NUM:
+            result = _interpreter_get_num_val(state, tree, &stack[stack_size++]);
+            break;
+        case CODE_LOAD:
+            result = _interpreter_require_symbol(current_scope, tree->symbol,
+                                                 &stack[stack_size++]);
+            break;
+        case CODE_LOAD_SLOT:
+            result = _interpreter_load_slot(current_scope, instruction,
+                                            &stack[stack_size++]);
+            break;
+        case CODE_POP:
+            libab_ref_free(&stack[--stack_size]);
+            break;
+        case CODE_SCOPE_ENTER:
+            result = libab_create_table(state->ab, &scopes[scope_count],
+                                        current_scope);
+            if(result == LIBAB_SUCCESS) {
+                current_scope = &scopes[scope_count++];
             }
-        }
-
-        libab_ref_copy(&function, into);
-        libab_ref_free(&function);
-    } else if(tree->variant == TREE_RESERVED_OP) {
-        const libab_reserved_operator* op = 
-            libab_find_reserved_operator(tree->string_value);
-        result = op->function(state->ab, scope,
+            break;
+        case CODE_SCOPE_EXIT:
+            libab_ref_free(&scopes[--scope_count]);
+            current_scope = scope_count ? &scopes[scope_count - 1] : scope;
+            break;
+        case CODE_JUMP:
+            pc = instruction->arg;
+            break;
+        case CODE_JUMP_FALSE:
+        case CODE_JUMP_TRUE:
+            if(tree->checked &&
+               tree->checked_epoch ==
+                   libab_get_root(state->ab)->tables.function_epoch) {
+                value = *((int*) libab_ref_get(
+                    &((libab_value*) libab_ref_get(&stack[--stack_size]))->data));
+            } else {
+                result = _interpreter_expect_boolean(state, &stack[--stack_size],
+                                                     &value);
+            }
+            libab_ref_free(&stack[stack_size]);
+            if(result == LIBAB_SUCCESS &&
+               !value == (instruction->op == CODE_JUMP_FALSE)) {
+                pc = instruction->arg;
+            }
+            break;
+        case CODE_CALL:
+        case CODE_TAIL_CALL:
+            callee = stack[--stack_size];
+            result = _interpreter_pop_params(stack, &stack_size,
+                                             instruction->arg, &params);
+            if(result == LIBAB_SUCCESS) {
+                state->tail_call = instruction->op == CODE_TAIL_CALL;
+                result = _interpreter_try_call(state, &callee, &params,
+                                               _interpreter_get_cache(instruction),
+                                               &stack[stack_size++]);
+                state->tail_call = 0;
+                libab_ref_vec_free(&params);
+            }
+            libab_ref_free(&callee);
+            if(result == LIBAB_SUCCESS &&
+               libab_ref_get(&state->tail_function)) {
+                /* The rest of the code only exits scopes. */
+                pc = code->size;
+                tail = 1;
+            }
+            break;
+        case CODE_OPERATOR:
+            result = _interpreter_pop_params(stack, &stack_size,
+                                             tree->variant == TREE_OP ? 2 : 1,
+                                             &params);
+            if(result == LIBAB_SUCCESS) {
+                result = _interpreter_call_operator(state, tree, &params,
+                                                    current_scope,
+                                                    _interpreter_get_cache(instruction),
+                                                    &stack[stack_size++]);
+                libab_ref_vec_free(&params);
+            }
+            break;
+        case CODE_FUN:
+            result = _interpreter_define_function(state, tree, current_scope,
+                                                  &stack[stack_size++]);
+            break;
+        case CODE_RESERVED:
+            result = libab_find_reserved_operator(tree->string_value)->function(
+                state->ab, current_scope,
                 vec_index(&tree->children, 0),
                 vec_index(&tree->children, 1),
-                into);
-    } else if(tree->variant == TREE_TRUE) {
-        libab_get_true_value(state->ab, into);
-    } else if(tree->variant == TREE_FALSE) {
-        libab_get_false_value(state->ab, into);
-    } else if (tree->variant == TREE_IF) {
-        int value;
-        result = _interpreter_expect_boolean(state,
-                vec_index(&tree->children, 0), &value, scope, SCOPE_NORMAL);
+                &stack[stack_size++]);
+            break;
+        }
+    }
 
-        if(result == LIBAB_SUCCESS) {
-            result = _interpreter_run(state, vec_index(&tree->children,
-                        value ? 1 : 2), into, scope, SCOPE_FORCE);
-        } else {
-            libab_ref_null(into);
+    if(result == LIBAB_SUCCESS && !tail) {
+        *into = stack[0];
+    } else {
+        while(stack_size) {
+            libab_ref_free(&stack[--stack_size]);
         }
-    } else if(tree->variant == TREE_WHILE) {
-        int value;
-        libab_get_unit_value(state->ab, into);
-        while(result == LIBAB_SUCCESS && (result = RUN_CHECK(0)) == LIBAB_SUCCESS && value) {
-            libab_ref_free(into);
-            result = _interpreter_run(state, vec_index(&tree->children, 1), 
-                                      into, scope, SCOPE_FORCE);
+        while(scope_count) {
+            libab_ref_free(&scopes[--scope_count]);
         }
+        libab_ref_null(into);
+    }
 
-        if(result != LIBAB_SUCCESS) {
-            libab_ref_free(into);
-            libab_ref_null(into);
-        }
-    } else if(tree->variant == TREE_DOWHILE) {
-        int value;
-        libab_get_unit_value(state->ab, into);
-        do {
-            libab_ref_free(into);
-            result = _interpreter_run(state, vec_index(&tree->children, 0),
-                                      into, scope, SCOPE_FORCE);
-        } while(result == LIBAB_SUCCESS && (result = RUN_CHECK(1)) == LIBAB_SUCCESS && value);
+    if(stack != local_stack) {
+        free(stack);
+    }
+    if(scopes != local_scopes) {
+        free(scopes);
+    }
 
-        if(result != LIBAB_SUCCESS) {
-            libab_ref_free(into);
-            libab_ref_null(into);
+    return result;
+}
+
+libab_result _interpreter_run(struct interpreter_state* state, libab_tree* tree,
+                              libab_ref* into, libab_ref* scope,
+                              libab_interpreter_scope_mode mode) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_code code;
+
+    if(tree->code == NULL) {
+        if((tree->code = malloc(sizeof(*tree->code)))) {
+            result = libab_code_init(tree->code, tree, mode);
+            if(result != LIBAB_SUCCESS) {
+                free(tree->code);
+                tree->code = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
         }
-    } else {
-        libab_get_unit_value(state->ab, into);
     }
 
-    if (needs_scope) {
-        libab_ref_free(&new_scope);
+    if(result != LIBAB_SUCCESS) {
+        libab_ref_null(into);
+    } else if(tree->code->mode == mode) {
+        result = _interpreter_execute(state, tree->code, scope, into);
+    } else {
+        /* The cached code was compiled with a different
+         * scope mode; compile this tree once more, without caching. */
+        result = libab_code_init(&code, tree, mode);
+        if(result == LIBAB_SUCCESS) {
+            result = _interpreter_execute(state, &code, scope, into);
+            libab_code_free(&code);
+        } else {
+            libab_ref_null(into);
+        }
     }
 
     return result;
@@ -1307,6 +1808,19 @@ libab_result libab_interpreter_run(libab_interpreter* intr, libab_tree* tree,
     return result;
 }
 
+libab_result libab_interpreter_run_code(libab_interpreter* intr,
+                                        struct libab_code_s* code,
+                                        libab_ref* scope, libab_ref* into) {
+    struct interpreter_state state;
+    libab_result result;
+
+    _interpreter_init(&state, intr, scope);
+    result = _interpreter_execute(&state, code, scope, into);
+    _interpreter_free(&state);
+
+    return result;
+}
+
 libab_result libab_interpreter_call_function(libab_interpreter* intr,
                                             libab_ref* scope,
                                             const char* function,
@@ -1323,7 +1837,8 @@ libab_result libab_interpreter_call_function(libab_interpreter* intr,
                                         function, &function_value);
     if(result == LIBAB_SUCCESS) {
         libab_ref_free(into);
-        result = _interpreter_try_call(&state, &function_value, params, into);
+        result = _interpreter_try_call(&state, &function_value, params, NULL,
+                                       into);
     }
 
     _interpreter_free(&state);
@@ -1341,12 +1856,60 @@ libab_result libab_interpreter_call_value(libab_interpreter* intr,
     libab_result result = LIBAB_SUCCESS;
 
     _interpreter_init(&state, intr, scope);
-    result = _interpreter_try_call(&state, function, params, into);
+    result = _interpreter_try_call(&state, function, params, NULL, into);
     _interpreter_free(&state);
     
     return result;
 }
 
+libab_result libab_interpreter_call_cached(libab_interpreter* intr,
+                                          libab_ref* scope,
+                                          libab_ref* function,
+                                          libab_ref_vec* params,
+                                          struct libab_call_cache_s* cache,
+                                          libab_ref* into) {
+    struct interpreter_state state;
+    libab_result result = LIBAB_SUCCESS;
+
+    _interpreter_init(&state, intr, scope);
+    result = _interpreter_try_call(&state, function, params, cache, into);
+    _interpreter_free(&state);
+
+    return result;
+}
+
+libab_result libab_interpreter_select_overload(libab_interpreter* intr,
+                                               libab_ref* function,
+                                               libab_ref_vec* params,
+                                               libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_value* function_value = libab_ref_get(function);
+    libab_parsetype* function_type = libab_ref_get(&function_value->type);
+    libab_ref_vec new_types;
+    libab_ref_trie param_map;
+
+    if (function_type->data_u.base ==
+        libab_get_basetype_function_list(intr->ab)) {
+        result = _interpreter_find_match(libab_ref_get(&function_value->data),
+                                         params, &new_types, &param_map, into,
+                                         0);
+        if (result == LIBAB_SUCCESS && libab_ref_get(into) == NULL) {
+            result = LIBAB_BAD_CALL;
+        } else if (result == LIBAB_SUCCESS) {
+            libab_ref_vec_free(&new_types);
+            libab_ref_trie_free(&param_map);
+        }
+    } else if (function_type->data_u.base ==
+               libab_get_basetype_function(intr->ab)) {
+        libab_ref_copy(function, into);
+    } else {
+        libab_ref_null(into);
+        result = LIBAB_BAD_CALL;
+    }
+
+    return result;
+}
+
 void libab_interpreter_unit_value(libab_interpreter* intr, libab_ref* into) {
     libab_ref_copy(&intr->value_unit, into);
 }
@@ -1,22 +1,24 @@
 #include "libabacus.h"
+#include "code.h"
 #include "debug.h"
 #include "lexer.h"
 #include "reserved.h"
 #include "util.h"
 #include "value.h"
 #include <stdlib.h>
+#include <string.h>
 #include "free_functions.h"
 
-static libab_basetype _basetype_function_list = {libab_free_function_list, NULL, 0};
+static libab_basetype _basetype_function_list = {libab_free_function_list, NULL, 0, 0};
 
 static libab_basetype_param _basetype_function_params[] = {{BT_LIST, NULL}};
 
 static libab_basetype _basetype_function = {libab_free_function,
-                                            _basetype_function_params, 1};
+                                            _basetype_function_params, 1, 0};
 
-static libab_basetype _basetype_unit = { libab_free_unit, NULL, 0 };
+static libab_basetype _basetype_unit = { libab_free_unit, NULL, 0, 0 };
 
-static libab_basetype _basetype_bool = { libab_free_bool, NULL, 0 };
+static libab_basetype _basetype_bool = { libab_free_bool, NULL, 0, 0 };
 
 libab_result _prepare_types(libab* ab, void (*free_function)(void*));
 
@@ -25,17 +27,50 @@ libab_result libab_init(libab* ab, void* (*parse_function)(const char*),
     int parser_initialized = 0;
     int lexer_initialized = 0;
     int interpreter_initialized = 0;
+    int symbols_initialized = 0;
+    int types_initialized = 0;
     libab_ref null_ref;
     libab_result result;
-    libab_gc_list_init(&ab->containers);
+    libab_gc_list_init(&ab->young_containers, ab);
+    libab_gc_list_init(&ab->old_containers, ab);
+    ab->gc_threshold = LIBABACUS_GC_DEFAULT_THRESHOLD;
+    ab->gc_major_interval = LIBABACUS_GC_DEFAULT_MAJOR_INTERVAL;
+    ab->gc_allocations = 0;
+    ab->gc_minor_collections = 0;
+    ab->function_list_generation = 0;
+    ab->parse_generation = 0;
+    libab_table_shared_init(&ab->tables);
+    ab->static_checks = 0;
+    ab->prototype = NULL;
+    ab->owns_lexer = 0;
     libab_ref_null(&null_ref);
+    libab_ref_null(&ab->table);
     libab_ref_null(&ab->type_num);
     libab_ref_null(&ab->type_bool);
     libab_ref_null(&ab->type_function_list);
     libab_ref_null(&ab->type_unit);
 
     ab->impl.parse_num = parse_function;
-    result = libab_create_table(ab, &ab->table, &null_ref);
+    ab->impl.parse_num_inline = NULL;
+    libab_ref_trie_init(&ab->literals);
+    ab->literal_count = 0;
+    libab_parse_cache_init(&ab->parse_cache);
+    result = libab_ref_pool_create(&ab->ref_pool);
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_symbols_init(&ab->symbols);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        symbols_initialized = 1;
+        result = libab_type_interner_init(&ab->types);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        types_initialized = 1;
+        libab_ref_free(&ab->table);
+        result = libab_create_table(ab, &ab->table, &null_ref);
+    }
 
     if (result == LIBAB_SUCCESS) {
         libab_ref_free(&ab->type_num);
@@ -61,6 +96,10 @@ libab_result libab_init(libab* ab, void* (*parse_function)(const char*),
         result = libab_register_reserved_operators(&ab->lexer);
     }
 
+    if (result == LIBAB_SUCCESS) {
+        ab->owns_lexer = 1;
+    }
+
     if (result != LIBAB_SUCCESS) {
         libab_ref_free(&ab->table);
         libab_ref_free(&ab->type_num);
@@ -79,12 +118,139 @@ libab_result libab_init(libab* ab, void* (*parse_function)(const char*),
         if (lexer_initialized) {
             libab_lexer_free(&ab->lexer);
         }
+
+        libab_ref_trie_free(&ab->literals);
+        libab_parse_cache_free(&ab->parse_cache);
+        libab_gc_collect(ab);
+        if (ab->ref_pool) {
+            libab_ref_pool_release(ab->ref_pool);
+        }
+        if (symbols_initialized) {
+            libab_symbols_free(&ab->symbols);
+        }
+        if (types_initialized) {
+            libab_type_interner_free(&ab->types);
+        }
+        libab_table_shared_free(&ab->tables);
     }
     libab_ref_free(&null_ref);
 
     return result;
 }
 
+libab_result libab_init_clone(libab* ab, libab* prototype) {
+    int types_initialized = 0;
+    libab_result result;
+
+    libab_gc_list_init(&ab->young_containers, ab);
+    libab_gc_list_init(&ab->old_containers, ab);
+    ab->gc_threshold = prototype->gc_threshold;
+    ab->gc_major_interval = prototype->gc_major_interval;
+    ab->gc_allocations = 0;
+    ab->gc_minor_collections = 0;
+    ab->function_list_generation = 0;
+    ab->parse_generation = 0;
+    libab_table_shared_init(&ab->tables);
+    ab->static_checks = prototype->static_checks;
+    ab->prototype = prototype;
+    ab->owns_lexer = 0;
+    ab->impl = prototype->impl;
+    libab_ref_null(&ab->table);
+    libab_ref_copy(&prototype->type_num, &ab->type_num);
+    libab_ref_copy(&prototype->type_bool, &ab->type_bool);
+    libab_ref_copy(&prototype->type_function_list, &ab->type_function_list);
+    libab_ref_copy(&prototype->type_unit, &ab->type_unit);
+    libab_ref_trie_init(&ab->literals);
+    ab->literal_count = 0;
+    libab_parse_cache_init(&ab->parse_cache);
+    result = libab_ref_pool_create(&ab->ref_pool);
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_parse_cache_resize(&ab->parse_cache,
+                                          prototype->parse_cache.capacity);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_type_interner_init_copy(&ab->types, &prototype->types);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        types_initialized = 1;
+        libab_ref_free(&ab->table);
+        result = libab_create_table(ab, &ab->table, &prototype->table);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        libab_parser_init(&ab->parser, ab);
+        result = libab_interpreter_init(&ab->intr, ab);
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        libab_ref_free(&ab->table);
+        libab_ref_free(&ab->type_num);
+        libab_ref_free(&ab->type_bool);
+        libab_ref_free(&ab->type_function_list);
+        libab_ref_free(&ab->type_unit);
+        libab_ref_trie_free(&ab->literals);
+        libab_parse_cache_free(&ab->parse_cache);
+        libab_gc_collect(ab);
+        if (ab->ref_pool) {
+            libab_ref_pool_release(ab->ref_pool);
+        }
+        if (types_initialized) {
+            libab_type_interner_free(&ab->types);
+        }
+        libab_table_shared_free(&ab->tables);
+    }
+
+    return result;
+}
+
+/**
+ * Gets the lexer of the given instance, which is
+ * its prototype's if it has none of its own.
+ */
+libab_lexer* _get_lexer(libab* ab) {
+    return ab->owns_lexer ? &ab->lexer : _get_lexer(ab->prototype);
+}
+
+libab_result _foreach_add_operator(libab_table_entry* entry, const char* name,
+                                   va_list args) {
+    char op_buffer[8];
+    libab_result result = LIBAB_SUCCESS;
+    if (entry->variant == ENTRY_OP) {
+        libab_sanitize(op_buffer, name, 8);
+        result = libab_convert_lex_result(eval_config_add(
+            &va_arg(args, libab_lexer*)->config, op_buffer, TOKEN_OP));
+    }
+    return result;
+}
+
+/**
+ * Gives a clone a lexer of its own, which recognizes all the
+ * operators registered with its prototypes.
+ */
+libab_result _own_lexer(libab* ab) {
+    libab_table* table = libab_ref_get(&ab->table);
+    libab_result result = libab_lexer_init(&ab->lexer);
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_register_reserved_operators(&ab->lexer);
+        while (result == LIBAB_SUCCESS && table) {
+            result = libab_table_foreach(table, _foreach_add_operator,
+                                         &ab->lexer);
+            table = libab_ref_get(&table->parent);
+        }
+        if (result == LIBAB_SUCCESS) {
+            ab->owns_lexer = 1;
+        } else {
+            libab_lexer_free(&ab->lexer);
+        }
+    }
+
+    return result;
+}
+
 void _initialize_behavior(libab_behavior* behavior, libab_ref* type,
                           libab_function_ptr func) {
     behavior->variant = BIMPL_INTERNAL;
@@ -104,10 +270,18 @@ libab_result _register_operator(libab* ab, const char* op,
         new_operator = &(new_entry->data_u.op);
         result = libab_operator_init(new_operator, token_type, precedence, associativity,
                             function);
+        if (result == LIBAB_SUCCESS) {
+            result = libab_symbols_intern(libab_get_symbols(ab), function,
+                                          &new_operator->function_symbol);
+        }
     } else {
         result = LIBAB_MALLOC;
     }
 
+    if (result == LIBAB_SUCCESS && !ab->owns_lexer) {
+        result = _own_lexer(ab);
+    }
+
     if (result == LIBAB_SUCCESS) {
         libab_sanitize(op_buffer, op, 8);
         result = libab_convert_lex_result(
@@ -118,10 +292,17 @@ libab_result _register_operator(libab* ab, const char* op,
         result = libab_table_put(libab_ref_get(&ab->table), op, new_entry);
     }
 
+    if (result == LIBAB_SUCCESS) {
+        libab_get_root(ab)->parse_generation++;
+        libab_parse_cache_clear(&ab->parse_cache);
+    }
+
     if (result != LIBAB_SUCCESS) {
         if (new_operator)
             libab_operator_free(new_operator);
-        eval_config_remove(&ab->lexer.config, op, TOKEN_OP);
+        if (ab->owns_lexer) {
+            eval_config_remove(&ab->lexer.config, op, TOKEN_OP);
+        }
         free(new_entry);
     }
 
@@ -188,19 +369,27 @@ libab_result libab_register_basetype(libab* ab, const char* name,
         result = libab_table_put(libab_ref_get(&ab->table), name, new_entry);
     }
 
-    if (result != LIBAB_SUCCESS) {
+    if (result == LIBAB_SUCCESS) {
+        libab_get_root(ab)->parse_generation++;
+        libab_parse_cache_clear(&ab->parse_cache);
+    } else {
         free(new_entry);
     }
 
     return result;
 }
 
+libab_result libab_freeze(libab* ab) {
+    return libab_table_freeze(libab_ref_get(&ab->table));
+}
+
 libab_result _prepare_types(libab* ab, void (*free_function)(void*)) {
     libab_result result = LIBAB_SUCCESS;
 
     ab->basetype_num.count = 0;
     ab->basetype_num.params = NULL;
     ab->basetype_num.free_function = free_function;
+    ab->basetype_num.inline_size = 0;
 
     libab_ref_null(&ab->type_num);
     libab_ref_null(&ab->type_bool);
@@ -230,6 +419,22 @@ libab_result _prepare_types(libab* ab, void (*free_function)(void*)) {
         result = libab_instantiate_basetype(&_basetype_unit, &ab->type_unit, 0);
     }
 
+    if (result == LIBAB_SUCCESS) {
+        result = libab_intern_type(ab, &ab->type_num);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_intern_type(ab, &ab->type_bool);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_intern_type(ab, &ab->type_function_list);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_intern_type(ab, &ab->type_unit);
+    }
+
     if (result == LIBAB_SUCCESS) {
         result = libab_register_basetype(ab, "num", &ab->basetype_num);
     }
@@ -269,7 +474,7 @@ libab_result libab_create_type(libab* ab, libab_ref* into, const char* type) {
     libab_result result;
     ll tokens;
     ll_init(&tokens);
-    result = libab_lexer_lex(&ab->lexer, type, &tokens);
+    result = libab_lexer_lex(_get_lexer(ab), type, &tokens);
     if (result == LIBAB_SUCCESS) {
         result = libab_parser_parse_type(&ab->parser, &tokens, type, into);
     }
@@ -277,12 +482,64 @@ libab_result libab_create_type(libab* ab, libab_ref* into, const char* type) {
         result = libab_resolve_parsetype_inplace(libab_ref_get(into),
                                          libab_ref_get(&ab->table));
     }
+    if (result == LIBAB_SUCCESS) {
+        result = libab_intern_type(ab, into);
+    }
     ll_foreach(&tokens, NULL, compare_always, libab_lexer_foreach_match_free);
     ll_free(&tokens);
     return result;
 }
 
-libab_basetype* libab_get_basetype_num(libab* ab) { return &ab->basetype_num; }
+libab_result libab_intern_type(libab* ab, libab_ref* type) {
+    libab_ref canonical;
+    libab_result result =
+        libab_type_interner_intern(&ab->types, type, &canonical);
+    if (result == LIBAB_SUCCESS) {
+        libab_ref_free(type);
+        *type = canonical;
+    }
+    return result;
+}
+
+libab* libab_get_root(libab* ab) {
+    while (ab->prototype) {
+        ab = ab->prototype;
+    }
+    return ab;
+}
+
+int libab_value_callable(libab_ref* value) {
+    libab_value* data = libab_ref_get(value);
+    libab_basetype* base = NULL;
+    if (data) {
+        base = ((libab_parsetype*)libab_ref_get(&data->type))->data_u.base;
+    }
+    return base == &_basetype_function || base == &_basetype_function_list;
+}
+
+libab_symbols* libab_get_symbols(libab* ab) {
+    return &libab_get_root(ab)->symbols;
+}
+
+libab_basetype* libab_get_basetype_num(libab* ab) {
+    return ab->prototype ? libab_get_basetype_num(ab->prototype)
+                         : &ab->basetype_num;
+}
+
+libab_result libab_declare_num_inline(libab* ab, size_t size,
+                                      void (*parse_function)(const char*,
+                                                             void*)) {
+    libab_result result = LIBAB_SUCCESS;
+    if (ab->prototype) {
+        result = LIBAB_BAD_CALL;
+    } else if (size == 0 || size > LIBABACUS_VALUE_INLINE_SIZE) {
+        result = LIBAB_BAD_TYPE;
+    } else {
+        ab->basetype_num.inline_size = size;
+        ab->impl.parse_num_inline = parse_function;
+    }
+    return result;
+}
 
 libab_basetype* libab_get_basetype_bool(libab* ab) { return &_basetype_bool; }
 
@@ -336,7 +593,7 @@ libab_result libab_parse(libab* ab, const char* string, libab_tree** into) {
 
     ll_init(&tokens);
     *into = NULL;
-    result = libab_lexer_lex(&ab->lexer, string, &tokens);
+    result = libab_lexer_lex(_get_lexer(ab), string, &tokens);
 
     if(result == LIBAB_SUCCESS) {
         result = libab_parser_parse(&ab->parser, &tokens, string, into);
@@ -347,6 +604,45 @@ libab_result libab_parse(libab* ab, const char* string, libab_tree** into) {
     return result;
 }
 
+libab_result libab_parse_shared(libab* ab, const char* string,
+                                libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_tree* root;
+    size_t generation = libab_get_root(ab)->parse_generation;
+
+    libab_parse_cache_find(&ab->parse_cache, string, generation, into);
+    if (libab_ref_get(into) == NULL) {
+        libab_ref_free(into);
+        result = libab_parse(ab, string, &root);
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_new(into, root, libab_free_tree);
+            if (result != LIBAB_SUCCESS) {
+                libab_tree_free_recursive(root);
+            }
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = libab_parse_cache_put(&ab->parse_cache, string,
+                                           generation, into);
+            if (result != LIBAB_SUCCESS) {
+                libab_ref_free(into);
+            }
+        }
+        if (result != LIBAB_SUCCESS) {
+            libab_ref_null(into);
+        }
+    }
+
+    return result;
+}
+
+libab_result libab_set_parse_cache_size(libab* ab, size_t size) {
+    return libab_parse_cache_resize(&ab->parse_cache, size);
+}
+
+void libab_set_static_checks(libab* ab, int enabled) {
+    ab->static_checks = enabled;
+}
+
 libab_result _handle_va_params(libab* ab, libab_ref_vec* into, size_t param_count, va_list args) {
     libab_result result = libab_ref_vec_init(into);
     if(result == LIBAB_SUCCESS) {
@@ -363,15 +659,16 @@ libab_result _handle_va_params(libab* ab, libab_ref_vec* into, size_t param_coun
 
 libab_result libab_run(libab* ab, const char* string, libab_ref* value) {
     libab_result result;
-    libab_tree* root;
+    libab_ref root;
 
     libab_ref_null(value);
-    result = libab_parse(ab, string, &root);
+    result = libab_parse_shared(ab, string, &root);
 
     if (result == LIBAB_SUCCESS) {
         libab_ref_free(value);
-        result = libab_interpreter_run(&ab->intr, root, &ab->table, SCOPE_FORCE, value);
-        libab_tree_free_recursive(root);
+        result = libab_interpreter_run(&ab->intr, libab_ref_get(&root),
+                                       &ab->table, SCOPE_FORCE, value);
+        libab_ref_free(&root);
     }
 
     return result;
@@ -404,14 +701,15 @@ libab_result libab_run_tree(libab* ab, libab_tree* tree, libab_ref* value) {
 
 libab_result libab_run_scoped(libab* ab, const char* string, libab_ref* scope, libab_ref* into) {
     libab_result result;
-    libab_tree* root;
+    libab_ref root;
 
     libab_ref_null(into);
-    result = libab_parse(ab, string, &root);
+    result = libab_parse_shared(ab, string, &root);
     if(result == LIBAB_SUCCESS) {
         libab_ref_free(into);
-        result = libab_interpreter_run(&ab->intr, root, scope, SCOPE_NONE, into);
-        libab_tree_free_recursive(root);
+        result = libab_interpreter_run(&ab->intr, libab_ref_get(&root), scope,
+                                       SCOPE_NONE, into);
+        libab_ref_free(&root);
     }
 
     return result;
@@ -437,12 +735,228 @@ libab_result libab_call_function_scoped(libab* ab, const char* function, libab_r
     return result;
 }
 
+libab_result libab_lookup_function(libab* ab, const char* function,
+                                   libab_function_handle* into) {
+    return libab_lookup_function_scoped(ab, function, &ab->table, into);
+}
+
+libab_result libab_lookup_function_scoped(libab* ab, const char* function,
+                                          libab_ref* scope,
+                                          libab_function_handle* into) {
+    libab_result result = LIBAB_SUCCESS;
+
+    libab_table_search_value(libab_ref_get(scope), function, &into->function);
+    if (libab_ref_get(&into->function) == NULL) {
+        result = LIBAB_UNEXPECTED;
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        libab_ref_copy(scope, &into->scope);
+        /* The cache is only an optimization, so the handle
+         * is still usable if it can't be allocated. */
+        if ((into->cache = malloc(sizeof(*into->cache)))) {
+            memset(into->cache, 0, sizeof(*into->cache));
+        }
+    } else {
+        libab_ref_free(&into->function);
+    }
+
+    return result;
+}
+
+libab_result libab_select_overload(libab* ab, libab_function_handle* handle,
+                                   libab_ref* params, size_t param_count) {
+    libab_result result;
+    libab_ref_vec param_vec;
+    libab_ref selected;
+
+    param_vec.capacity = param_count;
+    param_vec.size = param_count;
+    param_vec.data = params;
+    result = libab_interpreter_select_overload(&ab->intr, &handle->function,
+                                               &param_vec, &selected);
+    if (result == LIBAB_SUCCESS) {
+        libab_ref_free(&handle->function);
+        handle->function = selected;
+    } else {
+        libab_ref_free(&selected);
+    }
+
+    return result;
+}
+
+libab_result libab_call_handle(libab* ab, libab_function_handle* handle,
+                               libab_ref* into, libab_ref* params,
+                               size_t param_count) {
+    libab_ref_vec param_vec;
+
+    /* The interpreter never modifies the parameter vector, so it
+     * can borrow the caller's array instead of copying it. */
+    param_vec.capacity = param_count;
+    param_vec.size = param_count;
+    param_vec.data = params;
+    return libab_interpreter_call_cached(&ab->intr, &handle->scope,
+                                         &handle->function, &param_vec,
+                                         handle->cache, into);
+}
+
+void libab_function_handle_free(libab_function_handle* handle) {
+    libab_ref_free(&handle->function);
+    libab_ref_free(&handle->scope);
+    free(handle->cache);
+}
+
+/**
+ * Creates a new table for the bound variables of the given
+ * expression, with a slot holding a null reference for each.
+ */
+libab_result _prepared_bindings(libab* ab, libab_prepared* prepared) {
+    libab_result result;
+    libab_ref null_ref;
+    size_t index = 0;
+
+    libab_ref_null(&null_ref);
+    libab_ref_free(&prepared->bindings);
+    result = libab_create_table(ab, &prepared->bindings, &null_ref);
+    for (; index < prepared->count && result == LIBAB_SUCCESS; index++) {
+        result = libab_table_put_slot(libab_ref_get(&prepared->bindings),
+                                      prepared->symbols[index], &null_ref);
+    }
+    if (result != LIBAB_SUCCESS) {
+        libab_ref_free(&prepared->bindings);
+        libab_ref_null(&prepared->bindings);
+    }
+    libab_ref_free(&null_ref);
+
+    return result;
+}
+
+libab_result libab_prepare(libab* ab, const char* string, const char** names,
+                           size_t count, libab_prepared* into) {
+    libab_result result;
+    size_t index = 0;
+
+    into->tree = NULL;
+    into->code = NULL;
+    into->symbols = NULL;
+    into->count = count;
+    libab_ref_null(&into->bindings);
+    result = libab_parse(ab, string, &into->tree);
+
+    if (result == LIBAB_SUCCESS && count &&
+        (into->symbols = malloc(sizeof(*into->symbols) * count)) == NULL) {
+        result = LIBAB_MALLOC;
+    }
+    for (; index < count && result == LIBAB_SUCCESS; index++) {
+        result = libab_symbols_intern(libab_get_symbols(ab), names[index],
+                                      &into->symbols[index]);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        result = _prepared_bindings(ab, into);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        if ((into->code = malloc(sizeof(*into->code)))) {
+            /* Expressions that declare nothing run directly in the
+             * bindings table, which is kept from run to run unless
+             * something the expression created still refers to it. */
+            result = libab_code_init_bound(
+                into->code, into->tree,
+                libab_tree_declares(into->tree) ? SCOPE_FORCE : SCOPE_NONE,
+                into->symbols, count);
+            if (result != LIBAB_SUCCESS) {
+                free(into->code);
+                into->code = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        libab_prepared_free(into);
+    }
+
+    return result;
+}
+
+libab_result libab_run_prepared(libab* ab, libab_prepared* prepared,
+                                libab_ref* scope, libab_ref* values,
+                                libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table* bindings;
+    libab_table_entry* entry;
+    size_t index = 0;
+
+    /* Functions defined by a previous run keep their scope, so
+     * they must not see the values and scope of this run. */
+    if (libab_ref_get(&prepared->bindings) == NULL ||
+        prepared->bindings.count->strong > 1) {
+        result = _prepared_bindings(ab, prepared);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        bindings = libab_ref_get(&prepared->bindings);
+        libab_table_set_parent(bindings, scope);
+        for (; index < prepared->count; index++) {
+            entry = libab_table_get_slot(bindings, index);
+            libab_ref_free(&entry->data_u.value);
+            libab_ref_copy(&values[index], &entry->data_u.value);
+        }
+        result = libab_interpreter_run_code(&ab->intr, prepared->code,
+                                            &prepared->bindings, into);
+    } else {
+        libab_ref_null(into);
+    }
+
+    return result;
+}
+
+void libab_prepared_free(libab_prepared* prepared) {
+    if (prepared->code) {
+        libab_code_free(prepared->code);
+        free(prepared->code);
+    }
+    if (prepared->tree) {
+        libab_tree_free_recursive(prepared->tree);
+    }
+    libab_ref_free(&prepared->bindings);
+    free(prepared->symbols);
+}
+
 libab_result libab_run_tree_scoped(libab* ab, libab_tree* tree, libab_ref* scope, libab_ref* into) {
     return libab_interpreter_run(&ab->intr, tree, scope, SCOPE_NONE, into);
 }
 
+void libab_gc_collect(libab* ab) {
+    libab_gc_list_merge(&ab->old_containers, &ab->young_containers);
+    libab_gc_run(&ab->old_containers);
+    ab->gc_allocations = 0;
+    ab->gc_minor_collections = 0;
+}
+
+void libab_gc_collect_young(libab* ab) {
+    libab_gc_run_promote(&ab->young_containers, &ab->old_containers);
+    ab->gc_allocations = 0;
+    ab->gc_minor_collections++;
+}
+
+void libab_gc_allocated(libab* ab) {
+    ab->gc_allocations++;
+    if(ab->gc_threshold && ab->gc_allocations >= ab->gc_threshold) {
+        if(ab->gc_major_interval &&
+                ab->gc_minor_collections + 1 >= ab->gc_major_interval) {
+            libab_gc_collect(ab);
+        } else {
+            libab_gc_collect_young(ab);
+        }
+    }
+}
+
 libab_result libab_free(libab* ab) {
     libab_result result = LIBAB_SUCCESS;
+    libab_parse_cache_free(&ab->parse_cache);
     libab_table_free(libab_ref_get(&ab->table));
     libab_ref_free(&ab->table);
     libab_ref_free(&ab->type_num);
@@ -451,7 +965,16 @@ libab_result libab_free(libab* ab) {
     libab_ref_free(&ab->type_unit);
     libab_parser_free(&ab->parser);
     libab_interpreter_free(&ab->intr);
-    result = libab_lexer_free(&ab->lexer);
-    libab_gc_run(&ab->containers);
+    if (ab->owns_lexer) {
+        result = libab_lexer_free(&ab->lexer);
+    }
+    libab_ref_trie_free(&ab->literals);
+    libab_gc_collect(ab);
+    libab_ref_pool_release(ab->ref_pool);
+    if (!ab->prototype) {
+        libab_symbols_free(&ab->symbols);
+    }
+    libab_type_interner_free(&ab->types);
+    libab_table_shared_free(&ab->tables);
     return result;
 }
@@ -0,0 +1,175 @@
+#include "parse_cache.h"
+#include "util.h"
+#include <string.h>
+
+unsigned long _parse_cache_hash(const char* source) {
+    unsigned long hash = 5381;
+    while (*source) {
+        hash = hash * 33 + (unsigned char)*(source++);
+    }
+    return hash;
+}
+
+void libab_parse_cache_init(libab_parse_cache* cache) {
+    cache->buckets = NULL;
+    cache->bucket_count = 0;
+    cache->size = 0;
+    cache->capacity = 0;
+    cache->head = NULL;
+    cache->tail = NULL;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+void _parse_cache_unlink(libab_parse_cache* cache,
+                         libab_parse_cache_entry* entry) {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+}
+
+void _parse_cache_push_front(libab_parse_cache* cache,
+                             libab_parse_cache_entry* entry) {
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+/**
+ * Removes the given entry from the cache and frees it.
+ */
+void _parse_cache_remove(libab_parse_cache* cache,
+                         libab_parse_cache_entry* entry) {
+    libab_parse_cache_entry** link =
+        &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    while (*link != entry) {
+        link = &(*link)->chain;
+    }
+    *link = entry->chain;
+    _parse_cache_unlink(cache, entry);
+    cache->size--;
+
+    libab_ref_free(&entry->tree);
+    free(entry->source);
+    free(entry);
+}
+
+void libab_parse_cache_clear(libab_parse_cache* cache) {
+    while (cache->tail) {
+        _parse_cache_remove(cache, cache->tail);
+    }
+}
+
+libab_result libab_parse_cache_resize(libab_parse_cache* cache,
+                                      size_t capacity) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parse_cache_entry** new_buckets = NULL;
+    size_t new_count = 1;
+    size_t index = 0;
+
+    while (new_count < capacity) {
+        new_count *= 2;
+    }
+
+    /* The trees are discarded rather than rehashed, since a cache
+     * is resized far less often than it is refilled. */
+    libab_parse_cache_clear(cache);
+    if (capacity &&
+        (new_buckets = malloc(sizeof(*new_buckets) * new_count)) == NULL) {
+        result = LIBAB_MALLOC;
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        for (; index < new_count && new_buckets; index++) {
+            new_buckets[index] = NULL;
+        }
+        free(cache->buckets);
+        cache->buckets = new_buckets;
+        cache->bucket_count = capacity ? new_count : 0;
+        cache->capacity = capacity;
+    }
+
+    return result;
+}
+
+void libab_parse_cache_find(libab_parse_cache* cache, const char* source,
+                            size_t generation, libab_ref* into) {
+    libab_parse_cache_entry* entry = NULL;
+    unsigned long hash;
+
+    if (cache->capacity) {
+        hash = _parse_cache_hash(source);
+        entry = cache->buckets[hash & (cache->bucket_count - 1)];
+        while (entry &&
+               (entry->hash != hash || strcmp(entry->source, source) != 0)) {
+            entry = entry->chain;
+        }
+        if (entry && entry->generation != generation) {
+            _parse_cache_remove(cache, entry);
+            entry = NULL;
+        }
+        if (entry) {
+            cache->hits++;
+        } else {
+            cache->misses++;
+        }
+    }
+
+    if (entry) {
+        _parse_cache_unlink(cache, entry);
+        _parse_cache_push_front(cache, entry);
+        libab_ref_copy(&entry->tree, into);
+    } else {
+        libab_ref_null(into);
+    }
+}
+
+libab_result libab_parse_cache_put(libab_parse_cache* cache,
+                                   const char* source, size_t generation,
+                                   libab_ref* tree) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parse_cache_entry* entry = NULL;
+    libab_parse_cache_entry** bucket;
+
+    if (cache->capacity == 0) {
+    } else if ((entry = malloc(sizeof(*entry)))) {
+        result = libab_copy_string(&entry->source, source);
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    if (result == LIBAB_SUCCESS && entry) {
+        if (cache->size == cache->capacity) {
+            _parse_cache_remove(cache, cache->tail);
+        }
+        entry->hash = _parse_cache_hash(source);
+        entry->generation = generation;
+        libab_ref_copy(tree, &entry->tree);
+        bucket = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+        entry->chain = *bucket;
+        *bucket = entry;
+        _parse_cache_push_front(cache, entry);
+        cache->size++;
+    } else {
+        free(entry);
+    }
+
+    return result;
+}
+
+void libab_parse_cache_free(libab_parse_cache* cache) {
+    libab_parse_cache_clear(cache);
+    free(cache->buckets);
+}
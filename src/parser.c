@@ -338,11 +338,15 @@ libab_result _parser_allocate_node(libab_lexer_match* match,
     libab_result result = LIBAB_SUCCESS;
     if (((*into) = malloc(sizeof(**into))) == NULL) {
         result = LIBAB_MALLOC;
-    } else if (match) {
-        (*into)->from = match->from;
-        (*into)->to = match->to;
-        (*into)->line = match->line;
-        (*into)->line_from = match->line_from;
+    } else {
+        (*into)->code = NULL;
+        (*into)->checked = 0;
+        if (match) {
+            (*into)->from = match->from;
+            (*into)->to = match->to;
+            (*into)->line = match->line;
+            (*into)->line_from = match->line_from;
+        }
     }
     return result;
 }
@@ -354,6 +358,14 @@ libab_result _parser_construct_node_string(struct parser_state* state,
 
     if (result == LIBAB_SUCCESS) {
         result = _parser_extract_token(state, &(*into)->string_value, match);
+        if (result == LIBAB_SUCCESS) {
+            result = libab_symbols_intern(state->base_table->symbols,
+                                          (*into)->string_value,
+                                          &(*into)->symbol);
+            if (result != LIBAB_SUCCESS) {
+                free((*into)->string_value);
+            }
+        }
     }
 
     if (result != LIBAB_SUCCESS) {
@@ -400,6 +412,8 @@ libab_result _parse_void(struct parser_state* state, libab_tree** store_into) {
     libab_result result = LIBAB_SUCCESS;
     if ((*store_into = malloc(sizeof(**store_into)))) {
         (*store_into)->variant = TREE_VOID;
+        (*store_into)->code = NULL;
+        (*store_into)->checked = 0;
     } else {
         result = LIBAB_MALLOC;
     }
@@ -411,6 +425,8 @@ libab_result _parse_true(struct parser_state* state, libab_tree** store_into) {
     if(result == LIBAB_SUCCESS) {
         if ((*store_into = malloc(sizeof(**store_into)))) {
             (*store_into)->variant = TREE_TRUE;
+            (*store_into)->code = NULL;
+            (*store_into)->checked = 0;
         } else {
             result = LIBAB_MALLOC;
         }
@@ -427,6 +443,8 @@ libab_result _parse_false(struct parser_state* state, libab_tree** store_into) {
     if(result == LIBAB_SUCCESS) {
         if ((*store_into = malloc(sizeof(**store_into)))) {
             (*store_into)->variant = TREE_FALSE;
+            (*store_into)->code = NULL;
+            (*store_into)->checked = 0;
         } else {
             result = LIBAB_MALLOC;
         }
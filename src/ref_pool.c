@@ -0,0 +1,104 @@
+#include "ref_pool.h"
+#include <stdlib.h>
+
+libab_result libab_ref_pool_create(libab_ref_pool** into) {
+    libab_result result = LIBAB_SUCCESS;
+    if ((*into = malloc(sizeof(**into)))) {
+        (*into)->pages = NULL;
+        (*into)->free_list = NULL;
+        (*into)->free_blocks = NULL;
+        (*into)->page_count = 0;
+        (*into)->used = 0;
+        (*into)->max_pages = 0;
+        (*into)->released = 0;
+    } else {
+        result = LIBAB_MALLOC;
+    }
+    return result;
+}
+
+void _ref_pool_add_page(libab_ref_pool* pool) {
+    libab_ref_pool_page* page;
+    size_t index = 0;
+    if ((page = malloc(sizeof(*page)))) {
+        page->next = pool->pages;
+        pool->pages = page;
+        pool->page_count++;
+        for (; index < LIBABACUS_REF_POOL_PAGE_SIZE; index++) {
+            page->counts[index].pool = pool;
+            page->counts[index].next = pool->free_list;
+            pool->free_list = &page->counts[index];
+        }
+    }
+}
+
+libab_ref_count* libab_ref_pool_alloc(libab_ref_pool* pool) {
+    libab_ref_count* count;
+    if (pool->free_list == NULL &&
+        (pool->max_pages == 0 || pool->page_count < pool->max_pages)) {
+        _ref_pool_add_page(pool);
+    }
+
+    if ((count = pool->free_list)) {
+        pool->free_list = count->next;
+        pool->used++;
+    }
+    return count;
+}
+
+libab_value_inline* libab_ref_pool_alloc_value(libab_ref_pool* pool) {
+    libab_value_inline* value;
+    if (pool->free_blocks) {
+        value = (libab_value_inline*)pool->free_blocks;
+        pool->free_blocks = pool->free_blocks->next;
+    } else {
+        value = malloc(sizeof(*value));
+    }
+
+    if (value) {
+        value->block.pool = pool;
+        pool->used++;
+    }
+    return value;
+}
+
+void _ref_pool_destroy(libab_ref_pool* pool) {
+    libab_ref_pool_page* page;
+    libab_ref_block* block;
+    while ((page = pool->pages)) {
+        pool->pages = page->next;
+        free(page);
+    }
+    while ((block = pool->free_blocks)) {
+        pool->free_blocks = block->next;
+        free(block);
+    }
+    free(pool);
+}
+
+void libab_ref_pool_free(libab_ref_pool* pool, libab_ref_count* count) {
+    count->next = pool->free_list;
+    pool->free_list = count;
+    if (--pool->used == 0 && pool->released) {
+        _ref_pool_destroy(pool);
+    }
+}
+
+void libab_ref_pool_free_block(libab_ref_pool* pool, libab_ref_block* block) {
+    block->next = pool->free_blocks;
+    pool->free_blocks = block;
+    if (--pool->used == 0 && pool->released) {
+        _ref_pool_destroy(pool);
+    }
+}
+
+size_t libab_ref_pool_capacity(libab_ref_pool* pool) {
+    return pool->page_count * LIBABACUS_REF_POOL_PAGE_SIZE;
+}
+
+void libab_ref_pool_release(libab_ref_pool* pool) {
+    pool->released = 1;
+    if (pool->used == 0) {
+        _ref_pool_destroy(pool);
+    }
+}
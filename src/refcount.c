@@ -1,25 +1,53 @@
 #include "refcount.h"
+#include "ref_pool.h"
 #include <stdlib.h>
 #include <string.h>
 
-libab_result libab_ref_new(libab_ref* ref, void* data,
+void _libab_ref_count_init(libab_ref* ref, void* data,
                            void (*free_func)(void* data)) {
-    libab_result result = LIBAB_SUCCESS;
     ref->null = 0;
     ref->strong = 1;
-    if ((ref->count = malloc(sizeof(*(ref->count))))) {
-        ref->count->data = data;
-        ref->count->strong = ref->count->weak = 1;
-        ref->count->free_func = free_func;
-        ref->count->visit_children = NULL;
-        ref->count->prev = NULL;
-        ref->count->next = NULL;
+    ref->count->data = data;
+    ref->count->strong = ref->count->weak = 1;
+    ref->count->free_func = free_func;
+    ref->count->gc = -1;
+    ref->count->owner = NULL;
+    ref->count->visit_children = NULL;
+    ref->count->prev = NULL;
+    ref->count->next = NULL;
+    ref->count->block = NULL;
+}
+
+libab_result libab_ref_new_pooled(libab_ref* ref, void* data,
+                                  void (*free_func)(void* data),
+                                  libab_ref_pool* pool) {
+    libab_result result = LIBAB_SUCCESS;
+    ref->count = pool ? libab_ref_pool_alloc(pool) : NULL;
+    if (ref->count == NULL && (ref->count = malloc(sizeof(*(ref->count))))) {
+        ref->count->pool = NULL;
+    }
+    if (ref->count) {
+        _libab_ref_count_init(ref, data, free_func);
     } else {
         result = LIBAB_MALLOC;
     }
     return result;
 }
 
+void libab_ref_new_in_block(libab_ref* ref, libab_ref_count* count,
+                            libab_ref_block* block, void* data,
+                            void (*free_func)(void* data)) {
+    ref->count = count;
+    _libab_ref_count_init(ref, data, free_func);
+    ref->count->pool = NULL;
+    ref->count->block = block;
+}
+
+libab_result libab_ref_new(libab_ref* ref, void* data,
+                           void (*free_func)(void* data)) {
+    return libab_ref_new_pooled(ref, data, free_func, NULL);
+}
+
 void libab_ref_null(libab_ref* ref) { ref->null = 1; }
 
 void _libab_ref_changed(libab_ref* ref) {
@@ -32,7 +60,7 @@ void _libab_ref_changed(libab_ref* ref) {
     if (ref->count->weak == 0) {
         if(ref->count->prev) ref->count->prev->next = ref->count->next;
         if(ref->count->next) ref->count->next->prev = ref->count->prev;
-        free(ref->count);
+        libab_ref_count_free(ref->count);
     }
 }
 
@@ -76,3 +104,23 @@ void* libab_ref_get(const libab_ref* ref) {
     }
     return to_return;
 }
+
+void _libab_ref_block_free(libab_ref_block* block) {
+    if (block->pool) {
+        libab_ref_pool_free_block(block->pool, block);
+    } else {
+        free(block);
+    }
+}
+
+void libab_ref_count_free(libab_ref_count* count) {
+    if (count->block) {
+        if (--count->block->counts == 0) {
+            _libab_ref_block_free(count->block);
+        }
+    } else if (count->pool) {
+        libab_ref_pool_free(count->pool, count);
+    } else {
+        free(count);
+    }
+}
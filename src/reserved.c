@@ -8,10 +8,22 @@ libab_result _behavior_assign(libab* ab, libab_ref* scope,
                               libab_tree* left, libab_tree* right,
                               libab_ref* into) {
     libab_result result = LIBAB_SUCCESS;
+    libab_table_entry* replaced;
 
     if(left->variant == TREE_ID) {
         result = libab_run_tree_scoped(ab, right, scope, into);
         if(result == LIBAB_SUCCESS) {
+            replaced = libab_table_search_entry_value_symbol(
+                libab_ref_get(scope), left->symbol);
+        }
+        /* Clones share their prototype's globals, so they shadow
+         * them in their own global scope instead of changing them. */
+        if(result == LIBAB_SUCCESS && replaced && ab->prototype &&
+           replaced == libab_table_search_entry_value_symbol(
+               libab_ref_get(&ab->prototype->table), left->symbol)) {
+            result = libab_put_table_value(libab_ref_get(&ab->table),
+                                           left->string_value, into);
+        } else if(result == LIBAB_SUCCESS) {
             result = libab_set_variable(libab_ref_get(scope), left->string_value, into);
         }
 
@@ -0,0 +1,133 @@
+#include "symbol.h"
+#include "util.h"
+#include <string.h>
+
+unsigned long _symbols_hash(const char* name) {
+    unsigned long hash = 5381;
+    while (*name) {
+        hash = hash * 33 + (unsigned char)*(name++);
+    }
+    return hash;
+}
+
+/**
+ * Finds the bucket holding the symbol of the given name,
+ * or the empty bucket where it would be stored.
+ */
+size_t* _symbols_probe(libab_symbols* symbols, size_t* buckets, size_t count,
+                       const char* name) {
+    size_t mask = count - 1;
+    size_t index = _symbols_hash(name) & mask;
+    while (buckets[index] != LIBABACUS_SYMBOL_NONE &&
+           strcmp(symbols->names[buckets[index]], name) != 0) {
+        index = (index + 1) & mask;
+    }
+    return &buckets[index];
+}
+
+libab_result _symbols_alloc_buckets(size_t** into, size_t count) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+    if ((*into = malloc(sizeof(**into) * count))) {
+        for (; index < count; index++) {
+            (*into)[index] = LIBABACUS_SYMBOL_NONE;
+        }
+    } else {
+        result = LIBAB_MALLOC;
+    }
+    return result;
+}
+
+libab_result libab_symbols_init(libab_symbols* symbols) {
+    libab_result result = LIBAB_SUCCESS;
+    symbols->size = 0;
+    symbols->capacity = LIBABACUS_SYMBOLS_INITIAL_SIZE;
+    symbols->bucket_count = LIBABACUS_SYMBOLS_INITIAL_SIZE * 2;
+    symbols->buckets = NULL;
+
+    if ((symbols->names =
+             malloc(sizeof(*symbols->names) * symbols->capacity)) == NULL) {
+        result = LIBAB_MALLOC;
+    } else {
+        result = _symbols_alloc_buckets(&symbols->buckets,
+                                        symbols->bucket_count);
+        if (result != LIBAB_SUCCESS) {
+            free(symbols->names);
+        }
+    }
+
+    return result;
+}
+
+libab_result _symbols_grow(libab_symbols* symbols) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t new_capacity = symbols->capacity * 2;
+    size_t* new_buckets = NULL;
+    char** new_names;
+    size_t index = 0;
+
+    if ((new_names = realloc(symbols->names,
+                             sizeof(*new_names) * new_capacity))) {
+        symbols->names = new_names;
+        result = _symbols_alloc_buckets(&new_buckets, new_capacity * 2);
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        for (; index < symbols->size; index++) {
+            *_symbols_probe(symbols, new_buckets, new_capacity * 2,
+                            symbols->names[index]) = index;
+        }
+        free(symbols->buckets);
+        symbols->buckets = new_buckets;
+        symbols->bucket_count = new_capacity * 2;
+        symbols->capacity = new_capacity;
+    }
+
+    return result;
+}
+
+libab_result libab_symbols_intern(libab_symbols* symbols, const char* name,
+                                  size_t* into) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t* bucket = _symbols_probe(symbols, symbols->buckets,
+                                    symbols->bucket_count, name);
+
+    if (*bucket == LIBABACUS_SYMBOL_NONE) {
+        if (symbols->size == symbols->capacity) {
+            result = _symbols_grow(symbols);
+            if (result == LIBAB_SUCCESS) {
+                bucket = _symbols_probe(symbols, symbols->buckets,
+                                        symbols->bucket_count, name);
+            }
+        }
+        if (result == LIBAB_SUCCESS) {
+            result = libab_copy_string(&symbols->names[symbols->size], name);
+        }
+        if (result == LIBAB_SUCCESS) {
+            *bucket = symbols->size++;
+        }
+    }
+
+    *into = (result == LIBAB_SUCCESS) ? *bucket : LIBABACUS_SYMBOL_NONE;
+    return result;
+}
+
+size_t libab_symbols_find(libab_symbols* symbols, const char* name) {
+    return *_symbols_probe(symbols, symbols->buckets, symbols->bucket_count,
+                           name);
+}
+
+const char* libab_symbols_name(libab_symbols* symbols, size_t symbol) {
+    return symbols->names[symbol];
+}
+
+void libab_symbols_free(libab_symbols* symbols) {
+    size_t index = 0;
+    for (; index < symbols->size; index++) {
+        free(symbols->names[index]);
+    }
+    free(symbols->names);
+    free(symbols->buckets);
+}
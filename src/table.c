@@ -2,29 +2,245 @@
 #include "lexer.h"
 #include "util.h"
 #include <stdlib.h>
+#include <string.h>
 
-void libab_table_init(libab_table* table) {
-    libab_trie_init(&table->trie);
+#define LIBABACUS_TABLE_INITIAL_BUCKETS 8
+#define LIBABACUS_TABLE_KIND_VALUE 0
+#define LIBABACUS_TABLE_KIND_BASETYPE 1
+#define LIBABACUS_TABLE_KIND_TYPE_PARAM 2
+#define LIBABACUS_TABLE_KIND_OP 3
+#define LIBABACUS_TABLE_GROUP_SIZE 4
+
+void libab_table_shared_init(libab_table_shared* shared) {
+    shared->function_epoch = 0;
+    shared->operator_epoch = 0;
+    shared->next_id = 0;
+    shared->operator_symbols = NULL;
+    shared->operator_symbols_size = 0;
+    shared->operator_symbol_count = 0;
+}
+
+void libab_table_shared_free(libab_table_shared* shared) {
+    free(shared->operator_symbols);
+}
+
+void libab_table_init(libab_table* table, libab_symbols* symbols,
+                      libab_table_shared* shared) {
+    table->symbols = symbols;
+    table->shared = shared;
+    table->buckets = NULL;
+    table->bucket_count = 0;
+    table->size = 0;
+    table->displacements = NULL;
+    table->displacement_count = 0;
     libab_ref_null(&table->parent);
+    table->slots = NULL;
+    table->slot_count = 0;
+    table->slot_capacity = 0;
+    table->id = shared->next_id++;
+    table->generation = 0;
+    table->operators = 0;
+    table->operators_checked = shared->operator_symbol_count;
+}
+
+int _table_is_operator_symbol(libab_table_shared* shared, size_t symbol) {
+    return symbol < shared->operator_symbols_size &&
+           shared->operator_symbols[symbol];
+}
+
+/**
+ * Marks the given symbol as naming an operator
+ * or a function called by an operator.
+ */
+libab_result _table_mark_operator_symbol(libab_table_shared* shared,
+                                         size_t symbol) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t new_size = shared->operator_symbols_size
+                          ? shared->operator_symbols_size
+                          : LIBABACUS_TABLE_INITIAL_BUCKETS;
+    char* new_symbols;
+
+    while (new_size <= symbol) {
+        new_size *= 2;
+    }
+    if (new_size != shared->operator_symbols_size) {
+        if ((new_symbols = realloc(shared->operator_symbols,
+                                   sizeof(*new_symbols) * new_size))) {
+            memset(new_symbols + shared->operator_symbols_size, 0,
+                   new_size - shared->operator_symbols_size);
+            shared->operator_symbols = new_symbols;
+            shared->operator_symbols_size = new_size;
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS && !shared->operator_symbols[symbol]) {
+        shared->operator_symbols[symbol] = 1;
+        shared->operator_symbol_count++;
+    }
+
+    return result;
+}
+
+/**
+ * Records that an entry was stored in the table under the given symbol.
+ * If operator symbols were marked since the table was last checked,
+ * the table is checked again from scratch when it is next needed.
+ */
+void _table_note_symbol(libab_table* table, size_t symbol) {
+    if (table->operators_checked == table->shared->operator_symbol_count &&
+        _table_is_operator_symbol(table->shared, symbol)) {
+        table->operators = 1;
+    }
+}
+
+/**
+ * Finds the bucket holding the given symbol, or the
+ * empty bucket where it would be stored. Symbols are
+ * handed out in order, so they are spread out as they are.
+ */
+libab_table_bucket* _table_probe(libab_table_bucket* buckets, size_t count,
+                                 size_t symbol) {
+    size_t mask = count - 1;
+    size_t index = symbol & mask;
+    while (buckets[index].symbol != LIBABACUS_SYMBOL_NONE &&
+           buckets[index].symbol != symbol) {
+        index = (index + 1) & mask;
+    }
+    return &buckets[index];
 }
+
+size_t _table_mix(size_t value) {
+    value ^= value >> 16;
+    value *= 0x45d9f3bUL;
+    value ^= value >> 16;
+    value *= 0x45d9f3bUL;
+    value ^= value >> 16;
+    return value;
+}
+
+/**
+ * Gets the group of names a symbol belongs to in a frozen table.
+ * All names in a group share the same displacement.
+ */
+size_t _table_group(size_t symbol, size_t group_count) {
+    return _table_mix(symbol) & (group_count - 1);
+}
+
+/**
+ * Gets the bucket a symbol is stored in within a frozen table,
+ * given the displacement of its group.
+ */
+size_t _table_displace(size_t symbol, size_t displacement, size_t count) {
+    return _table_mix(symbol ^ ((displacement + 1) * 0x9e3779b9UL)) &
+           (count - 1);
+}
+
+libab_table_bucket* _table_find(libab_table* table, size_t symbol) {
+    libab_table_bucket* bucket = NULL;
+    if (table->displacements) {
+        bucket = &table->buckets[_table_displace(
+            symbol,
+            table->displacements[_table_group(symbol,
+                                              table->displacement_count)],
+            table->bucket_count)];
+        if (bucket->symbol != symbol) {
+            bucket = NULL;
+        }
+    } else if (table->buckets) {
+        bucket = _table_probe(table->buckets, table->bucket_count, symbol);
+        if (bucket->symbol == LIBABACUS_SYMBOL_NONE) {
+            bucket = NULL;
+        }
+    }
+    return bucket;
+}
+
+size_t _table_entry_kind(libab_table_entry* entry) {
+    size_t kind = LIBABACUS_TABLE_KIND_VALUE;
+    if (entry->variant == ENTRY_BASETYPE) {
+        kind = LIBABACUS_TABLE_KIND_BASETYPE;
+    } else if (entry->variant == ENTRY_TYPE_PARAM) {
+        kind = LIBABACUS_TABLE_KIND_TYPE_PARAM;
+    } else if (entry->variant == ENTRY_OP) {
+        kind = LIBABACUS_TABLE_KIND_OP + entry->data_u.op.variant - OPERATOR_PREFIX;
+    }
+    return kind;
+}
+
+size_t _table_frame_count(libab_table* table) {
+    return table->slot_count < LIBABACUS_TABLE_FRAME_SIZE
+               ? table->slot_count
+               : LIBABACUS_TABLE_FRAME_SIZE;
+}
+
+/**
+ * Searches the table's frame for an entry stored under the given
+ * symbol that matches the comparator. Frame entries are added
+ * before any other entry of the same name can be, so they come first.
+ */
+libab_table_entry* _table_search_frame(libab_table* table, size_t symbol,
+                                       void* data, compare_func compare) {
+    libab_table_entry* to_return = NULL;
+    size_t count = _table_frame_count(table);
+    size_t index = 0;
+    for (; index < count && to_return == NULL; index++) {
+        if (table->frame_symbols[index] == symbol &&
+            compare(data, &table->frame[index])) {
+            to_return = &table->frame[index];
+        }
+    }
+    return to_return;
+}
+
+/**
+ * Searches the table and its parents for the first entry
+ * of the given kind stored under the given symbol,
+ * storing the table it was found in into owner, if given.
+ */
+libab_table_entry* _table_search_kind(libab_table* table, size_t symbol,
+                                      size_t kind, libab_table** owner) {
+    libab_table_entry* to_return = NULL;
+    while (table && to_return == NULL && symbol != LIBABACUS_SYMBOL_NONE) {
+        libab_table_bucket* bucket;
+        if (kind == LIBABACUS_TABLE_KIND_VALUE) {
+            to_return = _table_search_frame(table, symbol, NULL,
+                                            libab_table_compare_value);
+        }
+        if (to_return == NULL && (bucket = _table_find(table, symbol))) {
+            to_return = bucket->entries[kind];
+        }
+        if (to_return && owner) {
+            *owner = table;
+        }
+        table = libab_ref_get(&table->parent);
+    }
+    return to_return;
+}
+
 libab_table_entry* libab_table_search_filter(libab_table* table,
                                              const char* string, void* data,
                                              compare_func compare) {
-    void* to_return = NULL;
-    do {
-        const ll* matches = libab_trie_get(&table->trie, string);
-        to_return = ll_find(matches, data, compare);
+    libab_table_entry* to_return = NULL;
+    size_t symbol = libab_symbols_find(table->symbols, string);
+    size_t kind;
+    while (table && to_return == NULL && symbol != LIBABACUS_SYMBOL_NONE) {
+        libab_table_bucket* bucket = _table_find(table, symbol);
+        to_return = _table_search_frame(table, symbol, data, compare);
+        for (kind = 0; bucket && kind < LIBABACUS_TABLE_ENTRY_KINDS &&
+                       to_return == NULL; kind++) {
+            to_return = bucket->entries[kind];
+            while (to_return && !compare(data, to_return)) {
+                to_return = to_return->next;
+            }
+        }
         table = libab_ref_get(&table->parent);
-    } while (table && to_return == NULL);
+    }
     return to_return;
 }
 libab_table_entry* libab_table_search(libab_table* table, const char* string) {
-    void* to_return = NULL;
-    do {
-        to_return = ll_head(libab_trie_get(&table->trie, string));
-        table = libab_ref_get(&table->parent);
-    } while (table && to_return == NULL);
-    return to_return;
+    return libab_table_search_filter(table, string, NULL, compare_always);
 }
 
 #define OP_TYPE_COMPARATOR(NAME, TYPE)                                         \
@@ -60,16 +276,18 @@ libab_operator* libab_table_search_operator(libab_table* table,
 }
 libab_table_entry* libab_table_search_entry_operator(libab_table* table,
                                                      const char* string, int type) {
+    return libab_table_search_entry_operator_symbol(
+        table, libab_symbols_find(table->symbols, string), type);
+}
+libab_table_entry* libab_table_search_entry_operator_symbol(libab_table* table,
+                                                            size_t symbol,
+                                                            int type) {
     libab_table_entry* entry = NULL;
-    if (type == OPERATOR_PREFIX) {
-        entry = libab_table_search_filter(table, string, NULL,
-                                          libab_table_compare_op_prefix);
-    } else if (type == OPERATOR_INFIX) {
-        entry = libab_table_search_filter(table, string, NULL,
-                                          libab_table_compare_op_infix);
-    } else if (type == OPERATOR_POSTFIX) {
-        entry = libab_table_search_filter(table, string, NULL,
-                                          libab_table_compare_op_postfix);
+    if (type == OPERATOR_PREFIX || type == OPERATOR_INFIX ||
+        type == OPERATOR_POSTFIX) {
+        entry = _table_search_kind(
+            table, symbol, LIBABACUS_TABLE_KIND_OP + type - OPERATOR_PREFIX,
+            NULL);
     }
     return entry;
 }
@@ -82,8 +300,8 @@ libab_basetype* libab_table_search_basetype(libab_table* table,
 }
 libab_table_entry* libab_table_search_entry_basetype(libab_table* table,
                                                      const char* string) {
-    return libab_table_search_filter(table, string, NULL, 
-                                     libab_table_compare_basetype);
+    return _table_search_kind(table, libab_symbols_find(table->symbols, string),
+                              LIBABACUS_TABLE_KIND_BASETYPE, NULL);
 }
 
 void libab_table_search_value(libab_table* table, const char* string,
@@ -98,8 +316,17 @@ void libab_table_search_value(libab_table* table, const char* string,
 }
 libab_table_entry* libab_table_search_entry_value(libab_table* table,
                                                   const char* string) {
-    return libab_table_search_filter(table, string, NULL,
-                                     libab_table_compare_value);
+    return libab_table_search_entry_value_symbol(
+        table, libab_symbols_find(table->symbols, string));
+}
+libab_table_entry* libab_table_search_entry_value_symbol(libab_table* table,
+                                                         size_t symbol) {
+    return _table_search_kind(table, symbol, LIBABACUS_TABLE_KIND_VALUE, NULL);
+}
+libab_table_entry* libab_table_search_entry_value_owner(libab_table* table,
+                                                        size_t symbol,
+                                                        libab_table** owner) {
+    return _table_search_kind(table, symbol, LIBABACUS_TABLE_KIND_VALUE, owner);
 }
 
 void libab_table_search_type_param(libab_table* table, const char* string,
@@ -114,31 +341,546 @@ void libab_table_search_type_param(libab_table* table, const char* string,
 }
 libab_table_entry* libab_table_search_entry_type_param(libab_table* table,
                                                        const char* string) {
-    return libab_table_search_filter(
-        table, string, NULL, libab_table_compare_type_param);
+    return _table_search_kind(table, libab_symbols_find(table->symbols, string),
+                              LIBABACUS_TABLE_KIND_TYPE_PARAM, NULL);
+}
+
+/**
+ * Lays the buckets out anew for linear probing, with room for
+ * at least one more name. This also thaws a frozen table.
+ */
+libab_result _table_grow(libab_table* table) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t new_count = LIBABACUS_TABLE_INITIAL_BUCKETS;
+    libab_table_bucket* new_buckets;
+    size_t index = 0;
+
+    while (new_count < (table->size + 1) * 2) {
+        new_count *= 2;
+    }
+
+    if ((new_buckets = malloc(sizeof(*new_buckets) * new_count))) {
+        for (; index < new_count; index++) {
+            new_buckets[index].symbol = LIBABACUS_SYMBOL_NONE;
+        }
+        for (index = 0; index < table->bucket_count; index++) {
+            libab_table_bucket* old = &table->buckets[index];
+            if (old->symbol != LIBABACUS_SYMBOL_NONE) {
+                *_table_probe(new_buckets, new_count, old->symbol) = *old;
+            }
+        }
+        free(table->buckets);
+        free(table->displacements);
+        table->buckets = new_buckets;
+        table->bucket_count = new_count;
+        table->displacements = NULL;
+        table->displacement_count = 0;
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    return result;
+}
+
+/**
+ * Sorts the table's occupied buckets by the group they belong to.
+ * Afterwards, the buckets of group i are found between
+ * members[starts[i]] and members[starts[i + 1]].
+ */
+void _table_sort_groups(libab_table* table, libab_table_bucket** members,
+                        size_t* starts, size_t group_count) {
+    size_t index = 0;
+    for (; index <= group_count; index++) {
+        starts[index] = 0;
+    }
+    for (index = 0; index < table->bucket_count; index++) {
+        if (table->buckets[index].symbol != LIBABACUS_SYMBOL_NONE) {
+            starts[_table_group(table->buckets[index].symbol, group_count) +
+                   1]++;
+        }
+    }
+    for (index = 1; index <= group_count; index++) {
+        starts[index] += starts[index - 1];
+    }
+    for (index = 0; index < table->bucket_count; index++) {
+        libab_table_bucket* bucket = &table->buckets[index];
+        if (bucket->symbol != LIBABACUS_SYMBOL_NONE) {
+            members[starts[_table_group(bucket->symbol, group_count)]++] =
+                bucket;
+        }
+    }
+    for (index = group_count; index > 0; index--) {
+        starts[index] = starts[index - 1];
+    }
+    starts[0] = 0;
+}
+
+/**
+ * Copies a group of buckets into the given buckets at the given
+ * displacement, unless one of them would land in a taken bucket.
+ * @return whether the group was placed.
+ */
+int _table_try_displacement(libab_table_bucket* buckets, size_t count,
+                            libab_table_bucket** group, size_t group_size,
+                            size_t displacement) {
+    size_t index = 0;
+    int placed = 1;
+    libab_table_bucket* target;
+
+    for (; index < group_size && placed; index++) {
+        target = &buckets[_table_displace(group[index]->symbol, displacement,
+                                          count)];
+        if (target->symbol == LIBABACUS_SYMBOL_NONE) {
+            *target = *group[index];
+        } else {
+            placed = 0;
+        }
+    }
+    if (!placed) {
+        index--;
+        while (index--) {
+            buckets[_table_displace(group[index]->symbol, displacement, count)]
+                .symbol = LIBABACUS_SYMBOL_NONE;
+        }
+    }
+
+    return placed;
+}
+
+/**
+ * Finds a displacement for every group, largest groups first,
+ * so that no two names share a bucket.
+ * @return whether every group was placed within the allowed attempts.
+ */
+int _table_place_groups(libab_table_bucket* buckets, size_t count,
+                        libab_table_bucket** members, size_t* starts,
+                        size_t* displacements, size_t group_count) {
+    size_t largest = 0;
+    size_t size;
+    size_t group;
+    int placed = 1;
+
+    for (group = 0; group < group_count; group++) {
+        displacements[group] = 0;
+        if (starts[group + 1] - starts[group] > largest) {
+            largest = starts[group + 1] - starts[group];
+        }
+    }
+    for (size = largest; size > 0 && placed; size--) {
+        for (group = 0; group < group_count && placed; group++) {
+            if (starts[group + 1] - starts[group] == size) {
+                while (displacements[group] < count * 4 &&
+                       !_table_try_displacement(buckets, count,
+                                                members + starts[group], size,
+                                                displacements[group])) {
+                    displacements[group]++;
+                }
+                placed = displacements[group] < count * 4;
+            }
+        }
+    }
+
+    return placed;
+}
+
+libab_result libab_table_foreach(libab_table* table,
+                                 libab_result (*func)(libab_table_entry*,
+                                                      const char*, va_list),
+                                 ...) {
+    va_list args;
+    libab_result result = LIBAB_SUCCESS;
+    libab_table_entry* entry;
+    size_t index = 0;
+    size_t kind;
+
+    for (; index < _table_frame_count(table) && result == LIBAB_SUCCESS;
+         index++) {
+        va_start(args, func);
+        result = func(&table->frame[index],
+                      libab_symbols_name(table->symbols,
+                                         table->frame_symbols[index]),
+                      args);
+        va_end(args);
+    }
+    for (index = 0; index < table->bucket_count; index++) {
+        libab_table_bucket* bucket = &table->buckets[index];
+        for (kind = 0; bucket->symbol != LIBABACUS_SYMBOL_NONE &&
+                       kind < LIBABACUS_TABLE_ENTRY_KINDS; kind++) {
+            entry = bucket->entries[kind];
+            while (entry && result == LIBAB_SUCCESS) {
+                va_start(args, func);
+                result = func(entry,
+                              libab_symbols_name(table->symbols,
+                                                 bucket->symbol),
+                              args);
+                va_end(args);
+                entry = entry->next;
+            }
+        }
+    }
+
+    return result;
+}
+
+libab_result libab_table_freeze(libab_table* table) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t count = 1;
+    size_t group_count = 1;
+    size_t index;
+    libab_table_bucket** members = NULL;
+    libab_table_bucket* new_buckets = NULL;
+    size_t* starts = NULL;
+    size_t* displacements = NULL;
+    int placed = (table->size == 0 || table->displacements != NULL);
+
+    while (count < table->size) {
+        count *= 2;
+    }
+    while (group_count * LIBABACUS_TABLE_GROUP_SIZE < table->size) {
+        group_count *= 2;
+    }
+
+    if (!placed) {
+        members = malloc(sizeof(*members) * table->size);
+        starts = malloc(sizeof(*starts) * (group_count + 1));
+        displacements = malloc(sizeof(*displacements) * group_count);
+        if (members && starts && displacements) {
+            _table_sort_groups(table, members, starts, group_count);
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    while (result == LIBAB_SUCCESS && !placed) {
+        if ((new_buckets = malloc(sizeof(*new_buckets) * count))) {
+            for (index = 0; index < count; index++) {
+                new_buckets[index].symbol = LIBABACUS_SYMBOL_NONE;
+            }
+            placed = _table_place_groups(new_buckets, count, members, starts,
+                                         displacements, group_count);
+            if (!placed) {
+                free(new_buckets);
+                new_buckets = NULL;
+                count *= 2;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS && new_buckets) {
+        free(table->buckets);
+        table->buckets = new_buckets;
+        table->bucket_count = count;
+        table->displacements = displacements;
+        table->displacement_count = group_count;
+    } else {
+        free(displacements);
+    }
+    free(members);
+    free(starts);
+
+    return result;
 }
 
 libab_result libab_table_put(libab_table* table, const char* string,
                              libab_table_entry* entry) {
-    return libab_trie_put(&table->trie, string, entry);
+    size_t symbol;
+    libab_result result = libab_symbols_intern(table->symbols, string, &symbol);
+    if (result == LIBAB_SUCCESS) {
+        result = libab_table_put_symbol(table, symbol, entry);
+    }
+    return result;
+}
+libab_result libab_table_put_symbol(libab_table* table, size_t symbol,
+                                    libab_table_entry* entry) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table_bucket* bucket;
+    libab_table_entry** tail;
+
+    if (entry->variant == ENTRY_OP) {
+        result = _table_mark_operator_symbol(table->shared, symbol);
+        if (result == LIBAB_SUCCESS) {
+            result = _table_mark_operator_symbol(
+                table->shared, entry->data_u.op.function_symbol);
+        }
+        table->shared->operator_epoch++;
+    }
+    if (result == LIBAB_SUCCESS &&
+        (table->displacements || (table->size + 1) * 2 > table->bucket_count)) {
+        result = _table_grow(table);
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        bucket = _table_probe(table->buckets, table->bucket_count, symbol);
+        if (bucket->symbol == LIBABACUS_SYMBOL_NONE) {
+            bucket->symbol = symbol;
+            memset(bucket->entries, 0, sizeof(bucket->entries));
+            table->size++;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        tail = &bucket->entries[_table_entry_kind(entry)];
+        while (*tail) {
+            tail = &(*tail)->next;
+        }
+        entry->next = NULL;
+        *tail = entry;
+        _table_note_symbol(table, symbol);
+    }
+
+    return result;
+}
+libab_result _table_put_overflow_slot(libab_table* table, size_t symbol,
+                                     libab_ref* value) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t overflow = table->slot_count - LIBABACUS_TABLE_FRAME_SIZE;
+    libab_table_entry* entry = NULL;
+
+    if (overflow == table->slot_capacity) {
+        size_t new_capacity = table->slot_capacity ? table->slot_capacity * 2 : 4;
+        libab_table_entry** new_slots =
+            realloc(table->slots, sizeof(*new_slots) * new_capacity);
+        if (new_slots) {
+            table->slots = new_slots;
+            table->slot_capacity = new_capacity;
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        if ((entry = malloc(sizeof(*entry)))) {
+            entry->variant = ENTRY_VALUE;
+            libab_ref_copy(value, &entry->data_u.value);
+            result = libab_table_put_symbol(table, symbol, entry);
+            if (result != LIBAB_SUCCESS) {
+                libab_ref_free(&entry->data_u.value);
+                free(entry);
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        table->slots[overflow] = entry;
+        table->slot_count++;
+    }
+
+    return result;
+}
+libab_result libab_table_put_slot(libab_table* table, size_t symbol,
+                                  libab_ref* value) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table_entry* entry;
+
+    if (table->slot_count < LIBABACUS_TABLE_FRAME_SIZE) {
+        entry = &table->frame[table->slot_count];
+        entry->variant = ENTRY_VALUE;
+        entry->next = NULL;
+        libab_ref_copy(value, &entry->data_u.value);
+        table->frame_symbols[table->slot_count++] = symbol;
+        _table_note_symbol(table, symbol);
+    } else {
+        result = _table_put_overflow_slot(table, symbol, value);
+    }
+
+    return result;
+}
+libab_table_entry* libab_table_get_slot(libab_table* table, size_t index) {
+    libab_table_entry* entry = NULL;
+    if (index < LIBABACUS_TABLE_FRAME_SIZE) {
+        entry = (index < table->slot_count) ? &table->frame[index] : NULL;
+    } else if (index < table->slot_count) {
+        entry = table->slots[index - LIBABACUS_TABLE_FRAME_SIZE];
+    }
+    return entry;
+}
+/**
+ * Checks whether the table holds an entry stored under a symbol
+ * naming an operator or a function called by an operator.
+ */
+int _table_holds_operators(libab_table* table) {
+    libab_table_shared* shared = table->shared;
+    size_t index = 0;
+
+    if (table->operators_checked != shared->operator_symbol_count) {
+        table->operators = 0;
+        for (; index < _table_frame_count(table) && !table->operators;
+             index++) {
+            table->operators =
+                _table_is_operator_symbol(shared, table->frame_symbols[index]);
+        }
+        for (index = 0; index < table->bucket_count && !table->operators;
+             index++) {
+            table->operators = _table_is_operator_symbol(
+                shared, table->buckets[index].symbol);
+        }
+        table->operators_checked = shared->operator_symbol_count;
+    }
+
+    return table->operators;
 }
-int _table_foreach_entry_free(void* data, va_list args) {
-    libab_table_entry_free(data);
-    free(data);
-    return 0;
+int libab_table_reaches(libab_table* table, libab_table* ancestor) {
+    while (table && table != ancestor && !_table_holds_operators(table)) {
+        table = libab_ref_get(&table->parent);
+    }
+    return table != NULL && table == ancestor;
+}
+void _table_free_entries(libab_table* table) {
+    size_t index = 0;
+    size_t kind;
+    libab_table_entry* entry;
+
+    for (; index < _table_frame_count(table); index++) {
+        libab_table_entry_free(&table->frame[index]);
+    }
+    table->slot_count = 0;
+
+    for (index = 0; index < table->bucket_count; index++) {
+        libab_table_bucket* bucket = &table->buckets[index];
+        for (kind = 0; bucket->symbol != LIBABACUS_SYMBOL_NONE &&
+                       kind < LIBABACUS_TABLE_ENTRY_KINDS; kind++) {
+            while ((entry = bucket->entries[kind])) {
+                bucket->entries[kind] = entry->next;
+                libab_table_entry_free(entry);
+                free(entry);
+            }
+        }
+    }
+    free(table->buckets);
+    free(table->displacements);
+    table->buckets = NULL;
+    table->bucket_count = 0;
+    table->size = 0;
+    table->displacements = NULL;
+    table->displacement_count = 0;
 }
 void libab_table_set_parent(libab_table* table, libab_ref* parent) {
     libab_ref_free(&table->parent);
     libab_ref_copy(parent, &table->parent);
 }
+/**
+ * Resolves the variable of the given binding again,
+ * giving it the given value.
+ */
+libab_result _table_binding_resolve(libab_table_binding* binding,
+                                    libab_ref* value) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table_entry* entry = NULL;
+    libab_table_bucket* bucket;
+    libab_table* table;
+    libab_ref owner;
+    libab_ref parent;
+
+    libab_ref_copy(&binding->scope, &owner);
+    while ((table = libab_ref_get(&owner)) && entry == NULL) {
+        entry = _table_search_frame(table, binding->symbol, NULL,
+                                    libab_table_compare_value);
+        if (entry == NULL && (bucket = _table_find(table, binding->symbol))) {
+            entry = bucket->entries[LIBABACUS_TABLE_KIND_VALUE];
+        }
+        if (entry == NULL) {
+            libab_ref_copy(&table->parent, &parent);
+            libab_ref_free(&owner);
+            owner = parent;
+        }
+    }
+
+    if (entry) {
+        libab_table_entry_set_value(table, entry, value);
+    } else {
+        libab_ref_free(&owner);
+        libab_ref_copy(&binding->scope, &owner);
+        table = libab_ref_get(&owner);
+        if (libab_value_callable(value)) {
+            table->shared->function_epoch++;
+        }
+        if ((entry = malloc(sizeof(*entry)))) {
+            entry->variant = ENTRY_VALUE;
+            libab_ref_copy(value, &entry->data_u.value);
+            result = libab_table_put_symbol(table, binding->symbol, entry);
+            if (result != LIBAB_SUCCESS) {
+                libab_ref_free(&entry->data_u.value);
+                free(entry);
+                entry = NULL;
+            }
+        } else {
+            result = LIBAB_MALLOC;
+        }
+    }
+
+    libab_ref_free(&binding->owner);
+    if (result == LIBAB_SUCCESS) {
+        binding->owner = owner;
+        binding->generation = table->generation;
+    } else {
+        libab_ref_free(&owner);
+        libab_ref_null(&binding->owner);
+    }
+    binding->entry = entry;
+
+    return result;
+}
+libab_result libab_table_bind(libab_ref* scope, const char* name,
+                              libab_ref* value, libab_table_binding* into) {
+    libab_table* table = libab_ref_get(scope);
+    libab_result result =
+        libab_symbols_intern(table->symbols, name, &into->symbol);
+    if (result == LIBAB_SUCCESS) {
+        libab_ref_copy(scope, &into->scope);
+        libab_ref_null(&into->owner);
+        result = _table_binding_resolve(into, value);
+        if (result != LIBAB_SUCCESS) {
+            libab_table_binding_free(into);
+        }
+    }
+    return result;
+}
+libab_result libab_table_binding_set(libab_table_binding* binding,
+                                     libab_ref* value) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_table* owner = libab_ref_get(&binding->owner);
+    if (binding->entry && owner->generation == binding->generation) {
+        libab_table_entry_set_value(owner, binding->entry, value);
+    } else {
+        result = _table_binding_resolve(binding, value);
+    }
+    return result;
+}
+void libab_table_binding_free(libab_table_binding* binding) {
+    libab_ref_free(&binding->scope);
+    libab_ref_free(&binding->owner);
+}
 void libab_table_clear(libab_table* table) {
-    libab_trie_clear(&table->trie);
+    if (_table_holds_operators(table)) {
+        table->shared->operator_epoch++;
+    }
+    table->generation++;
+    _table_free_entries(table);
 }
 void libab_table_free(libab_table* table) {
-    libab_trie_foreach(&table->trie, NULL, compare_always,
-                       _table_foreach_entry_free);
-    libab_trie_free(&table->trie);
+    if (_table_holds_operators(table)) {
+        table->shared->operator_epoch++;
+    }
+    table->generation++;
+    _table_free_entries(table);
     libab_ref_free(&table->parent);
+    libab_ref_null(&table->parent);
+    free(table->slots);
+    table->slots = NULL;
+    table->slot_capacity = 0;
+}
+void libab_table_entry_set_value(libab_table* table, libab_table_entry* entry,
+                                 libab_ref* value) {
+    if (libab_value_callable(&entry->data_u.value) ||
+        libab_value_callable(value)) {
+        table->shared->function_epoch++;
+    }
+    libab_ref_free(&entry->data_u.value);
+    libab_ref_copy(value, &entry->data_u.value);
 }
 void libab_table_entry_free(libab_table_entry* entry) {
     if (entry->variant == ENTRY_OP) {
@@ -1,5 +1,7 @@
 #include "tree.h"
+#include "code.h"
 #include <stdlib.h>
+#include <string.h>
 
 int libab_tree_has_vector(libab_tree_variant variant) {
     return variant == TREE_BASE || variant == TREE_OP ||
@@ -27,6 +29,22 @@ int libab_tree_has_type(libab_tree_variant variant) {
     return variant == TREE_FUN_PARAM || variant == TREE_FUN;
 }
 
+int libab_tree_declares(libab_tree* tree) {
+    int declares = 0;
+    size_t index = 0;
+
+    if (tree->variant == TREE_RESERVED_OP) {
+        declares = strcmp(tree->string_value, "=") == 0;
+    }
+    if (tree->variant != TREE_FUN && libab_tree_has_vector(tree->variant)) {
+        for (; index < tree->children.size && !declares; index++) {
+            declares = libab_tree_declares(vec_index(&tree->children, index));
+        }
+    }
+
+    return declares;
+}
+
 void libab_tree_free(libab_tree* tree) {
     int free_string = 0;
     int free_vector = 0;
@@ -40,6 +58,10 @@ void libab_tree_free(libab_tree* tree) {
         vec_free(&tree->children);
     if (free_type)
         libab_ref_free(&tree->type);
+    if (tree->code) {
+        libab_code_free(tree->code);
+        free(tree->code);
+    }
 }
 
 int _tree_foreach_free(void* data, va_list args) {
@@ -0,0 +1,278 @@
+#include "type_interner.h"
+#include "free_functions.h"
+#include <stdlib.h>
+
+#define LIBABACUS_TYPE_F_STRUCTURE                                            \
+    (LIBABACUS_TYPE_F_PARENT | LIBABACUS_TYPE_F_PLACE |                        \
+     LIBABACUS_TYPE_F_RESOLVED)
+
+libab_result _type_interner_alloc_entries(libab_type_interner_entry** into,
+                                          size_t count) {
+    libab_result result = LIBAB_SUCCESS;
+    size_t index = 0;
+    if ((*into = malloc(sizeof(**into) * count))) {
+        for (; index < count; index++) {
+            libab_ref_null(&(*into)[index].type);
+        }
+    } else {
+        result = LIBAB_MALLOC;
+    }
+    return result;
+}
+
+libab_result libab_type_interner_init(libab_type_interner* interner) {
+    interner->capacity = LIBABACUS_TYPE_INTERNER_INITIAL_SIZE;
+    interner->size = 0;
+    return _type_interner_alloc_entries(&interner->entries,
+                                        interner->capacity);
+}
+
+libab_result libab_type_interner_init_copy(libab_type_interner* interner,
+                                           libab_type_interner* copy_of) {
+    libab_result result;
+    size_t index = 0;
+
+    interner->capacity = copy_of->capacity;
+    interner->size = copy_of->size;
+    result = _type_interner_alloc_entries(&interner->entries,
+                                          interner->capacity);
+    for (; index < interner->capacity && result == LIBAB_SUCCESS; index++) {
+        interner->entries[index].hash = copy_of->entries[index].hash;
+        libab_ref_copy(&copy_of->entries[index].type,
+                       &interner->entries[index].type);
+    }
+
+    return result;
+}
+
+/**
+ * Checks whether every part of the given type is resolved,
+ * so that it can be made canonical.
+ */
+int _type_interner_internable(libab_parsetype* type) {
+    int internable = (type->variant & LIBABACUS_TYPE_F_INTERNED) ||
+                     ((type->variant & LIBABACUS_TYPE_F_RESOLVED) &&
+                      !(type->variant & LIBABACUS_TYPE_F_PLACE));
+    size_t index = 0;
+    if (!(type->variant & LIBABACUS_TYPE_F_INTERNED) &&
+        (type->variant & LIBABACUS_TYPE_F_PARENT)) {
+        for (; index < type->children.size && internable; index++) {
+            internable =
+                _type_interner_internable(libab_ref_get(&type->children.data[index]));
+        }
+    }
+    return internable;
+}
+
+/**
+ * Hashes a type from its basetype and its canonical children.
+ * Since the children are canonical, their addresses identify them.
+ */
+unsigned long _type_interner_hash(libab_parsetype* type,
+                                  libab_ref_vec* children) {
+    unsigned long hash = (unsigned long)(size_t)type->data_u.base >> 3;
+    size_t index = 0;
+    hash = hash * 33 + (type->variant & LIBABACUS_TYPE_F_STRUCTURE);
+    for (; children && index < children->size; index++) {
+        hash = hash * 33 +
+               ((unsigned long)(size_t)libab_ref_get(&children->data[index]) >> 3);
+    }
+    return hash;
+}
+
+/**
+ * Checks whether the given canonical type has the given
+ * basetype, variant and canonical children.
+ */
+int _type_interner_matches(libab_parsetype* canonical, libab_parsetype* type,
+                           libab_ref_vec* children) {
+    int matches =
+        canonical->data_u.base == type->data_u.base &&
+        (canonical->variant & LIBABACUS_TYPE_F_STRUCTURE) ==
+            (type->variant & LIBABACUS_TYPE_F_STRUCTURE);
+    size_t index = 0;
+    if (matches && children) {
+        matches = canonical->children.size == children->size;
+        for (; index < children->size && matches; index++) {
+            matches = libab_ref_get(&canonical->children.data[index]) ==
+                      libab_ref_get(&children->data[index]);
+        }
+    }
+    return matches;
+}
+
+/**
+ * Finds the entry holding the canonical type with the given
+ * hash, basetype and children, or the empty entry where it
+ * would be stored.
+ */
+libab_type_interner_entry* _type_interner_probe(
+    libab_type_interner_entry* entries, size_t capacity, unsigned long hash,
+    libab_parsetype* type, libab_ref_vec* children) {
+    size_t mask = capacity - 1;
+    size_t index = hash & mask;
+    while (!entries[index].type.null &&
+           (entries[index].hash != hash ||
+            !_type_interner_matches(libab_ref_get(&entries[index].type), type,
+                                    children))) {
+        index = (index + 1) & mask;
+    }
+    return &entries[index];
+}
+
+libab_result _type_interner_grow(libab_type_interner* interner) {
+    libab_result result;
+    libab_type_interner_entry* new_entries;
+    libab_type_interner_entry* entry;
+    size_t new_capacity = interner->capacity * 2;
+    size_t index = 0;
+    size_t slot;
+
+    result = _type_interner_alloc_entries(&new_entries, new_capacity);
+    for (; index < interner->capacity && result == LIBAB_SUCCESS; index++) {
+        entry = &interner->entries[index];
+        if (!entry->type.null) {
+            /* Canonical types are distinct, so each
+             * only needs an empty entry. */
+            slot = entry->hash & (new_capacity - 1);
+            while (!new_entries[slot].type.null) {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+            new_entries[slot] = *entry;
+        }
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        free(interner->entries);
+        interner->entries = new_entries;
+        interner->capacity = new_capacity;
+    }
+
+    return result;
+}
+
+/**
+ * Interns the children of the given type, storing the
+ * canonical children into the given vector.
+ */
+libab_result _type_interner_intern_children(libab_type_interner* interner,
+                                            libab_parsetype* type,
+                                            libab_ref_vec* into) {
+    libab_result result = libab_ref_vec_init(into);
+    libab_ref child;
+    size_t index = 0;
+
+    for (; index < type->children.size && result == LIBAB_SUCCESS; index++) {
+        result = libab_type_interner_intern(
+            interner, &type->children.data[index], &child);
+        if (result == LIBAB_SUCCESS) {
+            result = libab_ref_vec_insert(into, &child);
+        }
+        libab_ref_free(&child);
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        libab_ref_vec_free(into);
+    }
+
+    return result;
+}
+
+/**
+ * Stores a new canonical type into the given empty entry. The canonical
+ * type is a private copy of the given type, which is left untouched,
+ * since whoever holds it may go on to change it. The children vector
+ * is taken over by the copy.
+ */
+libab_result _type_interner_insert(libab_type_interner_entry* entry,
+                                   unsigned long hash, libab_ref* type,
+                                   libab_ref_vec* children,
+                                   int* children_taken) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parsetype* original = libab_ref_get(type);
+    libab_parsetype* copy;
+
+    if ((copy = malloc(sizeof(*copy)))) {
+        copy->variant = original->variant | LIBABACUS_TYPE_F_INTERNED;
+        copy->data_u.base = original->data_u.base;
+        if (children) {
+            copy->children = *children;
+            *children_taken = 1;
+        }
+        result = libab_ref_new(&entry->type, copy, libab_free_parsetype);
+        if (result != LIBAB_SUCCESS) {
+            free(copy);
+            *children_taken = 0;
+            libab_ref_null(&entry->type);
+        }
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    if (result == LIBAB_SUCCESS) {
+        entry->hash = hash;
+    }
+
+    return result;
+}
+
+libab_result libab_type_interner_intern(libab_type_interner* interner,
+                                        libab_ref* type, libab_ref* into) {
+    libab_result result = LIBAB_SUCCESS;
+    libab_parsetype* original = libab_ref_get(type);
+    libab_type_interner_entry* entry;
+    libab_ref_vec children;
+    libab_ref_vec* children_ptr = NULL;
+    int children_taken = 0;
+    unsigned long hash;
+
+    if ((original->variant & LIBABACUS_TYPE_F_INTERNED) ||
+        !_type_interner_internable(original)) {
+        libab_ref_copy(type, into);
+    } else {
+        if (original->variant & LIBABACUS_TYPE_F_PARENT) {
+            result = _type_interner_intern_children(interner, original,
+                                                    &children);
+            if (result == LIBAB_SUCCESS) {
+                children_ptr = &children;
+            }
+        }
+        if (result == LIBAB_SUCCESS &&
+            (interner->size + 1) * 2 > interner->capacity) {
+            result = _type_interner_grow(interner);
+        }
+
+        if (result == LIBAB_SUCCESS) {
+            hash = _type_interner_hash(original, children_ptr);
+            entry = _type_interner_probe(interner->entries, interner->capacity,
+                                         hash, original, children_ptr);
+            if (entry->type.null) {
+                result = _type_interner_insert(entry, hash, type, children_ptr,
+                                               &children_taken);
+                if (result == LIBAB_SUCCESS) {
+                    interner->size++;
+                }
+            }
+            if (result == LIBAB_SUCCESS) {
+                libab_ref_copy(&entry->type, into);
+            }
+        }
+
+        if (children_ptr && !children_taken) {
+            libab_ref_vec_free(children_ptr);
+        }
+        if (result != LIBAB_SUCCESS) {
+            libab_ref_null(into);
+        }
+    }
+
+    return result;
+}
+
+void libab_type_interner_free(libab_type_interner* interner) {
+    size_t index = 0;
+    for (; index < interner->capacity; index++) {
+        libab_ref_free(&interner->entries[index].type);
+    }
+    free(interner->entries);
+}
@@ -98,7 +98,7 @@ libab_result libab_resolve_parsetype_copy(libab_parsetype* to_resolve,
     libab_parsetype* parsetype;
     int is_placeholer = to_resolve->variant & LIBABACUS_TYPE_F_PLACE;
     if((parsetype = malloc(sizeof(*parsetype)))) {
-        parsetype->variant = to_resolve->variant;
+        parsetype->variant = to_resolve->variant & ~LIBABACUS_TYPE_F_INTERNED;
         if(!is_placeholer) {
             parsetype->variant |= LIBABACUS_TYPE_F_RESOLVED;
         }
@@ -193,31 +193,36 @@ void _gc_visit_table_entry(libab_table_entry* entry, libab_visitor_function_ptr
     }
 }
 
-void _gc_visit_table_trie(libab_trie_node* parent, libab_visitor_function_ptr visitor, void* data) {
-    ll_node* head;
-    if(parent == NULL) return;
-    head = parent->values.head;
-    _gc_visit_table_trie(parent->child, visitor, data);
-    _gc_visit_table_trie(parent->next, visitor, data);
-    while(head != NULL) {
-        _gc_visit_table_entry(head->data, visitor, data);
-        head = head->next;
-    }
-}
-
 void _gc_visit_table_children(void* parent, libab_visitor_function_ptr visitor, void* data) {
     libab_table* table = parent;
+    libab_table_entry* head;
+    size_t index = 0;
+    size_t kind;
     libab_gc_visit(&table->parent, visitor, data);
-    _gc_visit_table_trie(table->trie.head, visitor, data);
+    for(; index < table->slot_count && index < LIBABACUS_TABLE_FRAME_SIZE; index++) {
+        _gc_visit_table_entry(&table->frame[index], visitor, data);
+    }
+    for(index = 0; index < table->bucket_count; index++) {
+        for(kind = 0; table->buckets[index].symbol != LIBABACUS_SYMBOL_NONE &&
+                      kind < LIBABACUS_TABLE_ENTRY_KINDS; kind++) {
+            head = table->buckets[index].entries[kind];
+            while(head != NULL) {
+                _gc_visit_table_entry(head, visitor, data);
+                head = head->next;
+            }
+        }
+    }
 }
 
 libab_result libab_create_table(libab* ab, libab_ref* into, libab_ref* parent) {
     libab_table* table;
+    libab* root = libab_get_root(ab);
     libab_result result = LIBAB_SUCCESS;
     if ((table = malloc(sizeof(*table)))) {
-        libab_table_init(table);
+        libab_table_init(table, &root->symbols, &root->tables);
         libab_table_set_parent(table, parent);
-        result = libab_ref_new(into, table, libab_free_table);
+        result = libab_ref_new_pooled(into, table, libab_free_table,
+                                      ab->ref_pool);
 
         if (result != LIBAB_SUCCESS) {
             libab_free_table(table);
@@ -229,7 +234,8 @@ libab_result libab_create_table(libab* ab, libab_ref* into, libab_ref* parent) {
     if (result != LIBAB_SUCCESS) {
         libab_ref_null(into);
     } else {
-        libab_gc_add(into, _gc_visit_table_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_table_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
     return result;
 }
@@ -245,7 +251,8 @@ libab_result libab_create_value_ref(libab* ab, libab_ref* into,
     libab_result result = LIBAB_SUCCESS;
     if ((value = malloc(sizeof(*value)))) {
         libab_value_init_ref(value, data, type);
-        result = libab_ref_new(into, value, libab_free_value);
+        result = libab_ref_new_pooled(into, value, libab_free_value,
+                                      ab->ref_pool);
 
         if (result != LIBAB_SUCCESS) {
             libab_free_value(value);
@@ -257,7 +264,8 @@ libab_result libab_create_value_ref(libab* ab, libab_ref* into,
     if (result != LIBAB_SUCCESS) {
         libab_ref_null(into);
     } else {
-        libab_gc_add(into, _gc_visit_value_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_value_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
     return result;
 }
@@ -268,13 +276,14 @@ libab_result libab_create_value_raw(libab* ab, libab_ref* into,
     libab_result result = LIBAB_SUCCESS;
 
     if ((value = malloc(sizeof(*value)))) {
-        result = libab_value_init_raw(value, data, type);
+        result = libab_value_init_raw_pooled(value, data, type, ab->ref_pool);
     } else {
         result = LIBAB_MALLOC;
     }
 
     if (result == LIBAB_SUCCESS) {
-        result = libab_ref_new(into, value, libab_free_value);
+        result = libab_ref_new_pooled(into, value, libab_free_value,
+                                      ab->ref_pool);
         if (result != LIBAB_SUCCESS) {
             libab_value_free(value);
         }
@@ -284,7 +293,34 @@ libab_result libab_create_value_raw(libab* ab, libab_ref* into,
         libab_ref_null(into);
         free(value);
     } else {
-        libab_gc_add(into, _gc_visit_value_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_value_children, &ab->young_containers);
+        libab_gc_allocated(ab);
+    }
+
+    return result;
+}
+
+libab_result libab_create_value_inline(libab* ab, libab_ref* into,
+                                       const void* data, libab_ref* type) {
+    libab_value_inline* block;
+    libab_result result = LIBAB_SUCCESS;
+    libab_basetype* basetype =
+        ((libab_parsetype*)libab_ref_get(type))->data_u.base;
+
+    if (basetype->inline_size == 0 ||
+        basetype->inline_size > LIBABACUS_VALUE_INLINE_SIZE) {
+        result = LIBAB_BAD_TYPE;
+    } else if ((block = libab_ref_pool_alloc_value(ab->ref_pool))) {
+        libab_value_inline_init(block, data, basetype->inline_size, type, into);
+    } else {
+        result = LIBAB_MALLOC;
+    }
+
+    if (result != LIBAB_SUCCESS) {
+        libab_ref_null(into);
+    } else {
+        libab_gc_add(into, _gc_visit_value_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
 
     return result;
@@ -360,6 +396,58 @@ libab_result _register_function_new(libab* ab, const char* name,
 }
 
 
+/**
+ * Overloads a function stored in a prototype's table, which is
+ * shared with other clones and therefore not changed. Instead, the
+ * overloads are copied into a new entry in the clone's own table.
+ */
+libab_result _register_function_shared(libab* ab, const char* name,
+                                       libab_table_entry* entry,
+                                       libab_ref* function_val) {
+    libab_value* old_value;
+    libab_parsetype* old_type;
+    libab_function_list* list;
+    libab_function_list* old_list = NULL;
+    libab_ref new_list;
+    libab_ref old_function;
+    size_t index = 0;
+    libab_result result = LIBAB_SUCCESS;
+
+    old_value = libab_ref_get(&entry->data_u.value);
+    old_type = libab_ref_get(&old_value->type);
+
+    if (old_type->data_u.base == libab_get_basetype_function_list(ab) ||
+        old_type->data_u.base == libab_get_basetype_function(ab)) {
+        result =
+            _create_value_function_list(ab, &new_list, &ab->type_function_list);
+        if (result == LIBAB_SUCCESS) {
+            list = libab_ref_get(&((libab_value*)libab_ref_get(&new_list))->data);
+            if (old_type->data_u.base == libab_get_basetype_function_list(ab)) {
+                old_list = libab_ref_get(&old_value->data);
+            } else {
+                result = libab_function_list_insert(list, &entry->data_u.value);
+            }
+            for (; old_list && index < libab_function_list_size(old_list) &&
+                   result == LIBAB_SUCCESS; index++) {
+                libab_function_list_index(old_list, index, &old_function);
+                result = libab_function_list_insert(list, &old_function);
+                libab_ref_free(&old_function);
+            }
+            if (result == LIBAB_SUCCESS) {
+                result = libab_function_list_insert(list, function_val);
+            }
+            if (result == LIBAB_SUCCESS) {
+                result = _register_function_new(ab, name, &new_list);
+            }
+        }
+        libab_ref_free(&new_list);
+    } else {
+        result = _register_function_new(ab, name, function_val);
+    }
+
+    return result;
+}
+
 libab_result libab_overload_function(libab* ab,
                                      libab_table* table,
                                      const char* name,
@@ -368,7 +456,13 @@ libab_result libab_overload_function(libab* ab,
     libab_table_entry* existing_entry = libab_table_search_filter(
             table, name, NULL, libab_table_compare_value);
 
-    if (existing_entry) {
+    libab_get_root(ab)->tables.function_epoch++;
+    if (existing_entry && ab->prototype &&
+        existing_entry ==
+            libab_table_search_filter(libab_ref_get(&ab->prototype->table),
+                                      name, NULL, libab_table_compare_value)) {
+        result = _register_function_shared(ab, name, existing_entry, function);
+    } else if (existing_entry) {
         result = _register_function_existing(ab, existing_entry,
                 function);
     } else {
@@ -384,8 +478,7 @@ libab_result libab_set_variable(libab_table* table,
     libab_result result = LIBAB_SUCCESS;
     libab_table_entry* value_entry = libab_table_search_entry_value(table, name);
     if(value_entry) {
-        libab_ref_free(&value_entry->data_u.value);
-        libab_ref_copy(value, &value_entry->data_u.value);
+        libab_table_entry_set_value(table, value_entry, value);
     } else {
         result = libab_put_table_value(table, name, value);
     }
@@ -415,7 +508,8 @@ libab_result libab_create_function_internal(libab* ab, libab_ref* into,
     }
 
     if (result == LIBAB_SUCCESS) {
-        result = libab_ref_new(into, new_function, free_function);
+        result = libab_ref_new_pooled(into, new_function, free_function,
+                                      ab->ref_pool);
         if (result != LIBAB_SUCCESS) {
             libab_function_free(new_function);
         }
@@ -425,7 +519,8 @@ libab_result libab_create_function_internal(libab* ab, libab_ref* into,
         libab_ref_null(into);
         free(new_function);
     } else {
-        libab_gc_add(into, _gc_visit_function_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_function_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
 
     return result;
@@ -445,7 +540,8 @@ libab_result libab_create_function_tree(libab* ab, libab_ref* into,
     }
 
     if (result == LIBAB_SUCCESS) {
-        result = libab_ref_new(into, new_function, free_function);
+        result = libab_ref_new_pooled(into, new_function, free_function,
+                                      ab->ref_pool);
         if (result != LIBAB_SUCCESS) {
             libab_function_free(new_function);
         }
@@ -455,7 +551,8 @@ libab_result libab_create_function_tree(libab* ab, libab_ref* into,
         libab_ref_null(into);
         free(new_function);
     } else {
-        libab_gc_add(into, _gc_visit_function_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_function_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
 
     return result;
@@ -475,7 +572,8 @@ libab_result libab_create_function_behavior(libab* ab, libab_ref* into,
     }
 
     if(result == LIBAB_SUCCESS) {
-        result = libab_ref_new(into, new_function, free_function);
+        result = libab_ref_new_pooled(into, new_function, free_function,
+                                      ab->ref_pool);
         if(result != LIBAB_SUCCESS) {
             libab_function_free(new_function);
         }
@@ -485,7 +583,8 @@ libab_result libab_create_function_behavior(libab* ab, libab_ref* into,
         libab_ref_null(into);
         free(new_function);
     } else {
-        libab_gc_add(into, _gc_visit_function_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_function_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
 
     return result;
@@ -506,14 +605,16 @@ libab_result libab_create_function_list(libab* ab, libab_ref* into, libab_ref* t
 
     if ((list = malloc(sizeof(*list)))) {
         result = libab_function_list_init(list);
+        list->generation = ++libab_get_root(ab)->function_list_generation;
     } else {
         result = LIBAB_MALLOC;
     }
 
     if (result == LIBAB_SUCCESS) {
-        result = libab_ref_new(into, list,
+        result = libab_ref_new_pooled(into, list,
                                ((libab_parsetype*)libab_ref_get(type))
-                                   ->data_u.base->free_function);
+                                   ->data_u.base->free_function,
+                               ab->ref_pool);
         if (result != LIBAB_SUCCESS) {
             libab_function_list_free(list);
         }
@@ -523,7 +624,8 @@ libab_result libab_create_function_list(libab* ab, libab_ref* into, libab_ref* t
         libab_ref_null(into);
         free(list);
     } else {
-        libab_gc_add(into, _gc_visit_function_list_children, &ab->containers);
+        libab_gc_add(into, _gc_visit_function_list_children, &ab->young_containers);
+        libab_gc_allocated(ab);
     }
 
     return result;
@@ -532,8 +634,10 @@ libab_result libab_create_function_list(libab* ab, libab_ref* into, libab_ref* t
 libab_result libab_put_table_value(libab_table* table, const char* key,
                                    libab_ref* value) {
     libab_table_entry* entry;
-    libab_result result = LIBAB_SUCCESS;
-    if ((entry = malloc(sizeof(*entry)))) {
+    size_t symbol;
+    libab_result result = libab_symbols_intern(table->symbols, key, &symbol);
+    if (result != LIBAB_SUCCESS) {
+    } else if ((entry = malloc(sizeof(*entry)))) {
         entry->variant = ENTRY_VALUE;
         libab_ref_copy(value, &entry->data_u.value);
     } else {
@@ -541,16 +645,19 @@ libab_result libab_put_table_value(libab_table* table, const char* key,
     }
 
     if (result == LIBAB_SUCCESS) {
-        result = libab_table_put(table, key, entry);
+        result = libab_table_put_symbol(table, symbol, entry);
         if (result != LIBAB_SUCCESS) {
             libab_ref_free(&entry->data_u.value);
             free(entry);
+        } else if (libab_value_callable(value)) {
+            table->shared->function_epoch++;
         }
     }
 
     return result;
 }
 
+
 libab_basetype* libab_get_basetype(libab_parsetype* type, libab_table* scope) {
     libab_ref type_param;
     libab_basetype* to_return;
@@ -1,5 +1,7 @@
 #include "value.h"
 #include "parsetype.h"
+#include "free_functions.h"
+#include <string.h>
 
 void libab_value_init_ref(libab_value* value, libab_ref* data,
                           libab_ref* type) {
@@ -9,12 +11,19 @@ void libab_value_init_ref(libab_value* value, libab_ref* data,
 
 libab_result libab_value_init_raw(libab_value* value, void* data,
                                   libab_ref* type) {
+    return libab_value_init_raw_pooled(value, data, type, NULL);
+}
+
+libab_result libab_value_init_raw_pooled(libab_value* value, void* data,
+                                         libab_ref* type,
+                                         struct libab_ref_pool_s* pool) {
     libab_result result = LIBAB_SUCCESS;
     libab_ref tmp_ref;
 
-    result = libab_ref_new(
+    result = libab_ref_new_pooled(
         &tmp_ref, data,
-        ((libab_parsetype*)libab_ref_get(type))->data_u.base->free_function);
+        ((libab_parsetype*)libab_ref_get(type))->data_u.base->free_function,
+        pool);
 
     if (result == LIBAB_SUCCESS) {
         libab_value_init_ref(value, &tmp_ref, type);
@@ -24,6 +33,19 @@ libab_result libab_value_init_raw(libab_value* value, void* data,
     return result;
 }
 
+void libab_value_inline_init(libab_value_inline* block, const void* data,
+                             size_t size, libab_ref* type, libab_ref* into) {
+    libab_ref data_ref;
+    block->block.counts = 2;
+    memcpy(block->payload.bytes, data, size);
+    libab_ref_new_in_block(&data_ref, &block->data_count, &block->block,
+                           block->payload.bytes, NULL);
+    libab_value_init_ref(&block->value, &data_ref, type);
+    libab_ref_free(&data_ref);
+    libab_ref_new_in_block(into, &block->value_count, &block->block,
+                           &block->value, libab_free_value_inline);
+}
+
 void libab_value_free(libab_value* value) {
     libab_ref_free(&value->data);
     libab_ref_free(&value->type);
@@ -0,0 +1,124 @@
+#include "support.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Compares two numbers without returning a boolean,
+ * so that conditions calling it can not be trusted.
+ */
+libab_result function_unit_less(libab* ab, libab_ref* scope,
+                                libab_ref_vec* params, libab_ref* into) {
+    libab_get_unit_value(ab, into);
+    return LIBAB_SUCCESS;
+}
+
+/**
+ * Initializes an instance with static checks, and registers
+ * a comparison that returns unit instead of a boolean.
+ */
+libab_result check_init(libab* ab) {
+    libab_ref type;
+    libab_result result = test_init(ab);
+
+    if (result == LIBAB_SUCCESS) {
+        libab_set_static_checks(ab, 1);
+        result = libab_create_type(ab, &type, "(num, num)->unit");
+        if (result == LIBAB_SUCCESS) {
+            result = libab_register_function(ab, "uless", &type,
+                                             function_unit_less);
+            libab_ref_free(&type);
+        }
+        if (result != LIBAB_SUCCESS) {
+            libab_free(ab);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Runs the given code, and checks that it fails instead of
+ * trusting a condition that was checked before.
+ */
+int check_expect_failure(libab* ab, const char* code) {
+    libab_ref value;
+    libab_result result = libab_run(ab, code, &value);
+
+    if (result == LIBAB_SUCCESS) {
+        fprintf(stderr, "%s: ran with a stale check\n", code);
+        libab_ref_free(&value);
+    }
+
+    return result != LIBAB_SUCCESS;
+}
+
+/**
+ * Replaces the comparison a checked condition calls through
+ * the host API, so that the condition is checked again.
+ */
+int test_check_set_variable(void) {
+    libab ab;
+    libab_ref uless;
+    int passed = 0;
+
+    if (check_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    libab_table_search_value(libab_ref_get(&ab.table), "uless", &uless);
+    passed = test_expect_num(&ab, &ab.table,
+                             "fun k(x: num): num { if (x < 1) {1} else {2} }; "
+                             "k(0)",
+                             1) &&
+             libab_set_variable(libab_ref_get(&ab.table), "less", &uless) ==
+                 LIBAB_SUCCESS &&
+             check_expect_failure(&ab, "k(0)");
+    libab_ref_free(&uless);
+    libab_free(&ab);
+
+    return passed;
+}
+
+/**
+ * Replaces the comparison a checked condition calls in the
+ * prototype, after a clone defined as many functions as the
+ * prototype, so that the clone checks the condition again.
+ */
+int test_check_clone(void) {
+    libab prototype;
+    libab* clone;
+    int passed = 0;
+
+    if (check_init(&prototype) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if ((clone = malloc(sizeof(*clone)))) {
+        if (libab_init_clone(clone, &prototype) == LIBAB_SUCCESS) {
+            passed =
+                test_expect_num(&prototype, &prototype.table,
+                                "fun k(x: num): num { "
+                                "if (x < 1) {1} else {2} }; k(0)",
+                                1) &&
+                test_expect_num(clone, &clone->table,
+                                "fun f(x: num): num { x }; f(1)", 1) &&
+                test_expect_num(clone, &clone->table, "k(0)", 1) &&
+                test_expect_num(&prototype, &prototype.table,
+                                "less = uless; 0", 0) &&
+                check_expect_failure(clone, "k(0)");
+            libab_free(clone);
+        }
+        free(clone);
+    }
+    libab_free(&prototype);
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_check_set_variable();
+    passed &= test_check_clone();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+#include "support.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Runs a function defined by the prototype in a clone, so that the
+ * values the clone creates for its literals are released with it.
+ */
+int test_clone_literals(void) {
+    libab prototype;
+    libab* clone;
+    libab_ref value;
+    int passed = 0;
+
+    if (test_init(&prototype) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if (libab_run(&prototype, "fun inc(x: num): num { x + 1 }", &value) ==
+        LIBAB_SUCCESS) {
+        libab_ref_free(&value);
+        if ((clone = malloc(sizeof(*clone)))) {
+            if (libab_init_clone(clone, &prototype) == LIBAB_SUCCESS) {
+                passed = test_expect_num(clone, &clone->table, "inc(1)", 2);
+                libab_free(clone);
+            }
+            free(clone);
+        }
+        passed = passed &&
+                 test_expect_num(&prototype, &prototype.table, "inc(2)", 3);
+    }
+    libab_free(&prototype);
+
+    return passed;
+}
+
+/**
+ * Defines a function with the prototype after cloning it, and runs
+ * code in a scope of the clone, so that the clone's collections
+ * neither take the function's containers nor its name.
+ */
+int test_clone_gc(void) {
+    libab prototype;
+    libab* clone;
+    libab_ref scope;
+    libab_ref value;
+    int passed = 0;
+
+    if (test_init(&prototype) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if ((clone = malloc(sizeof(*clone)))) {
+        if (libab_init_clone(clone, &prototype) == LIBAB_SUCCESS) {
+            if (libab_run(&prototype, "fun g(x: num): num { x * 2 }",
+                          &value) == LIBAB_SUCCESS) {
+                libab_ref_free(&value);
+                if (libab_create_table(clone, &scope, &clone->table) ==
+                    LIBAB_SUCCESS) {
+                    passed = test_expect_num(clone, &scope, "h = 3", 3);
+                    libab_ref_free(&scope);
+                }
+            }
+            libab_free(clone);
+        }
+        free(clone);
+    }
+    passed = passed &&
+             test_expect_num(&prototype, &prototype.table, "g(2)", 4);
+    libab_free(&prototype);
+
+    return passed;
+}
+
+/**
+ * Assigns to a global of the prototype in one of two clones, so that
+ * only that clone sees the new value, and the prototype and the other
+ * clone keep the function their operators call.
+ */
+int test_clone_assign(void) {
+    libab prototype;
+    libab* clones;
+    int initialized = 0;
+    int passed = 0;
+
+    if (test_init(&prototype) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if ((clones = malloc(sizeof(*clones) * 2))) {
+        if (libab_init_clone(&clones[0], &prototype) == LIBAB_SUCCESS) {
+            initialized++;
+        }
+        if (initialized == 1 &&
+            libab_init_clone(&clones[1], &prototype) == LIBAB_SUCCESS) {
+            initialized++;
+        }
+        passed = initialized == 2 &&
+                 test_expect_num(&clones[0], &clones[0].table,
+                                 "less = plus; 1 < 2", 3) &&
+                 test_expect_num(&clones[1], &clones[1].table,
+                                 "if (1 < 2) {1} else {0}", 1) &&
+                 test_expect_num(&prototype, &prototype.table,
+                                 "if (1 < 2) {1} else {0}", 1) &&
+                 test_expect_num(&clones[0], &clones[0].table, "1 < 2", 3);
+        while (initialized > 0) {
+            libab_free(&clones[--initialized]);
+        }
+        free(clones);
+    }
+    libab_free(&prototype);
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_clone_literals();
+    passed &= test_clone_gc();
+    passed &= test_clone_assign();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+#include "support.h"
+#include "util.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Runs the given prepared expression in the given scope, and
+ * checks that it evaluates to the expected number.
+ */
+int expect_prepared_num(libab* ab, libab_prepared* prepared, libab_ref* scope,
+                        double expected) {
+    libab_ref value;
+    libab_result result = libab_run_prepared(ab, prepared, scope, NULL, &value);
+    int passed = 0;
+
+    if (result == LIBAB_SUCCESS) {
+        passed = *((double*)libab_unwrap_value(&value)) == expected;
+        if (!passed) {
+            fprintf(stderr, "prepared: wrong result (expected %f)\n",
+                    expected);
+        }
+    } else {
+        fprintf(stderr, "prepared: failed (error code %d)\n", result);
+    }
+    libab_ref_free(&value);
+
+    return passed;
+}
+
+/**
+ * Runs the same operator call in the global scope and in a scope
+ * where the function it calls is shadowed, so that the function
+ * cached by the call site is only reused where it is still visible.
+ */
+int test_operator_shadowed(void) {
+    libab ab;
+    libab_prepared prepared;
+    libab_ref scope;
+    libab_ref minus;
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    libab_table_search_value(libab_ref_get(&ab.table), "minus", &minus);
+    if (libab_create_table(&ab, &scope, &ab.table) == LIBAB_SUCCESS) {
+        if (libab_put_table_value(libab_ref_get(&scope), "plus", &minus) ==
+                LIBAB_SUCCESS &&
+            libab_prepare(&ab, "4 + 1", NULL, 0, &prepared) == LIBAB_SUCCESS) {
+            passed = expect_prepared_num(&ab, &prepared, &ab.table, 5) &&
+                     expect_prepared_num(&ab, &prepared, &ab.table, 5) &&
+                     expect_prepared_num(&ab, &prepared, &scope, 3) &&
+                     expect_prepared_num(&ab, &prepared, &ab.table, 5);
+            libab_prepared_free(&prepared);
+        }
+        libab_ref_free(&scope);
+    }
+    libab_ref_free(&minus);
+    libab_free(&ab);
+
+    return passed;
+}
+
+/**
+ * Registers an operator with a prototype after a clone cached a tree
+ * that parses its text as two operators, so that the clone parses
+ * the text again instead of reusing the tree.
+ */
+int test_operator_parse_cache(void) {
+    libab prototype;
+    libab* clone;
+    int passed = 0;
+
+    if (test_init(&prototype) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if ((clone = malloc(sizeof(*clone)))) {
+        if (libab_init_clone(clone, &prototype) == LIBAB_SUCCESS) {
+            passed =
+                test_expect_num(&prototype, &prototype.table,
+                                "fun neg(x: num): num { 0 - x }; 0", 0) &&
+                libab_register_operator_prefix(&prototype, "~", "neg") ==
+                    LIBAB_SUCCESS &&
+                libab_set_parse_cache_size(clone, 8) == LIBAB_SUCCESS &&
+                test_expect_num(clone, &clone->table, "1 +~ 2", -1) &&
+                test_expect_num(clone, &clone->table, "1 +~ 2", -1) &&
+                libab_register_operator_infix(&prototype, "+~", 2, -1,
+                                              "times") == LIBAB_SUCCESS &&
+                test_expect_num(clone, &clone->table, "1 +~ 2", 2) &&
+                test_expect_num(&prototype, &prototype.table, "1 +~ 2", 2);
+            libab_free(clone);
+        }
+        free(clone);
+    }
+    libab_free(&prototype);
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_operator_shadowed();
+    passed &= test_operator_parse_cache();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
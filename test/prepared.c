@@ -0,0 +1,112 @@
+#include "support.h"
+#include "util.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Runs the given prepared expression with the given value of its
+ * single bound variable, storing the output into the given reference.
+ */
+libab_result prepared_run_with(libab* ab, libab_prepared* prepared,
+                               const char* value_code, libab_ref* into) {
+    libab_ref value;
+    libab_result result = libab_run(ab, value_code, &value);
+
+    if (result == LIBAB_SUCCESS) {
+        result = libab_run_prepared(ab, prepared, &ab->table, &value, into);
+        libab_ref_free(&value);
+    } else {
+        libab_ref_null(into);
+    }
+
+    return result;
+}
+
+/**
+ * Runs the same prepared expression with different values,
+ * so that every run sees the value it was given.
+ */
+int test_prepared_repeated(void) {
+    libab ab;
+    libab_prepared prepared;
+    libab_ref output;
+    const char* names[] = {"x"};
+    double expected[] = {2, 11, 4};
+    const char* values[] = {"1", "10", "3"};
+    size_t index = 0;
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if (libab_prepare(&ab, "x + 1", names, 1, &prepared) == LIBAB_SUCCESS) {
+        passed = 1;
+        for (; index < 3 && passed; index++) {
+            passed = prepared_run_with(&ab, &prepared, values[index],
+                                       &output) == LIBAB_SUCCESS &&
+                     *((double*)libab_unwrap_value(&output)) ==
+                         expected[index];
+            libab_ref_free(&output);
+        }
+        libab_prepared_free(&prepared);
+    }
+    libab_free(&ab);
+
+    if (!passed) {
+        fprintf(stderr, "x + 1: wrong result in run %lu\n",
+                (unsigned long)index);
+    }
+
+    return passed;
+}
+
+/**
+ * Runs a prepared expression defining a function that captures
+ * a bound variable twice, so that the function returned by the
+ * first run still sees the value of the first run. The second
+ * run overloads the function, so only the first one is called.
+ */
+int test_prepared_closure(void) {
+    libab ab;
+    libab_prepared prepared;
+    libab_ref first;
+    libab_ref second;
+    libab_ref scope;
+    const char* names[] = {"x"};
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    libab_ref_null(&first);
+    libab_ref_null(&second);
+    if (libab_prepare(&ab, "fun g(a: num): num { a + x }; g", names, 1,
+                      &prepared) == LIBAB_SUCCESS) {
+        if (prepared_run_with(&ab, &prepared, "1", &first) == LIBAB_SUCCESS &&
+            prepared_run_with(&ab, &prepared, "10", &second) ==
+                LIBAB_SUCCESS &&
+            libab_create_table(&ab, &scope, &ab.table) == LIBAB_SUCCESS) {
+            passed = libab_put_table_value(libab_ref_get(&scope), "first",
+                                           &first) == LIBAB_SUCCESS &&
+                     test_expect_num(&ab, &scope, "first(0)", 1) &&
+                     test_expect_num(&ab, &scope, "first(2)", 3);
+            libab_ref_free(&scope);
+        }
+        libab_ref_free(&first);
+        libab_ref_free(&second);
+        libab_prepared_free(&prepared);
+    }
+    libab_free(&ab);
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_prepared_repeated();
+    passed &= test_prepared_closure();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+#include "support.h"
+#include "util.h"
+#include "value.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TRY(expression)                                                        \
+    if (result == LIBAB_SUCCESS)                                               \
+        result = expression;
+#define OP_FUNCTION(name, expression)                                          \
+    libab_result name(libab* ab, libab_ref* scope, libab_ref_vec* params,     \
+                      libab_ref* into) {                                       \
+        double left = *((double*)libab_unwrap_param(params, 0));               \
+        double right = *((double*)libab_unwrap_param(params, 1));              \
+        return create_double_value(ab, expression, into);                      \
+    }
+#define CMP_FUNCTION(name, expression)                                         \
+    libab_result name(libab* ab, libab_ref* scope, libab_ref_vec* params,     \
+                      libab_ref* into) {                                       \
+        double left = *((double*)libab_unwrap_param(params, 0));               \
+        double right = *((double*)libab_unwrap_param(params, 1));              \
+        libab_get_bool_value(ab, expression, into);                            \
+        return LIBAB_SUCCESS;                                                  \
+    }
+
+void* impl_parse(const char* string) {
+    double* data = malloc(sizeof(*data));
+    if (data) {
+        *data = strtod(string, NULL);
+    }
+    return data;
+}
+
+void impl_parse_inline(const char* string, void* into) {
+    *((double*)into) = strtod(string, NULL);
+}
+
+void impl_free(void* data) { free(data); }
+
+libab_result create_double_value(libab* ab, double val, libab_ref* into) {
+    libab_ref type_num;
+    libab_result result = LIBAB_SUCCESS;
+    libab_get_type_num(ab, &type_num);
+    result = libab_create_value_inline(ab, into, &val, &type_num);
+    libab_ref_free(&type_num);
+    return result;
+}
+
+OP_FUNCTION(function_plus, left + right)
+OP_FUNCTION(function_minus, left - right)
+OP_FUNCTION(function_times, left * right)
+CMP_FUNCTION(function_equals, left == right)
+CMP_FUNCTION(function_less, left < right)
+
+libab_result test_init(libab* ab) {
+    libab_result result;
+    libab_ref arithmetic_type;
+    libab_ref compare_type;
+    int initialized;
+
+    libab_ref_null(&arithmetic_type);
+    libab_ref_null(&compare_type);
+    result = libab_init(ab, impl_parse, impl_free);
+    initialized = result == LIBAB_SUCCESS;
+    TRY(libab_declare_num_inline(ab, sizeof(double), impl_parse_inline));
+    TRY(libab_create_type(ab, &arithmetic_type, "(num, num)->num"));
+    TRY(libab_create_type(ab, &compare_type, "(num, num)->bool"));
+    TRY(libab_register_function(ab, "plus", &arithmetic_type, function_plus));
+    TRY(libab_register_function(ab, "minus", &arithmetic_type, function_minus));
+    TRY(libab_register_function(ab, "times", &arithmetic_type, function_times));
+    TRY(libab_register_function(ab, "equals", &compare_type, function_equals));
+    TRY(libab_register_function(ab, "less", &compare_type, function_less));
+    TRY(libab_register_operator_infix(ab, "==", 0, -1, "equals"));
+    TRY(libab_register_operator_infix(ab, "<", 0, -1, "less"));
+    TRY(libab_register_operator_infix(ab, "+", 1, -1, "plus"));
+    TRY(libab_register_operator_infix(ab, "-", 1, -1, "minus"));
+    TRY(libab_register_operator_infix(ab, "*", 2, -1, "times"));
+
+    libab_ref_free(&arithmetic_type);
+    libab_ref_free(&compare_type);
+    if (result != LIBAB_SUCCESS && initialized) {
+        libab_free(ab);
+    }
+
+    return result;
+}
+
+int test_expect_num(libab* ab, libab_ref* scope, const char* code,
+                    double expected) {
+    libab_ref value;
+    libab_value* result_value;
+    libab_parsetype* result_type;
+    libab_result result = libab_run_scoped(ab, code, scope, &value);
+    int passed = 0;
+
+    if (result == LIBAB_SUCCESS) {
+        result_value = libab_ref_get(&value);
+        result_type = libab_ref_get(&result_value->type);
+        passed = result_type->data_u.base == libab_get_basetype_num(ab) &&
+                 *((double*)libab_ref_get(&result_value->data)) == expected;
+        if (!passed) {
+            fprintf(stderr, "%s: wrong result (expected %f)\n", code,
+                    expected);
+        }
+        libab_ref_free(&value);
+    } else {
+        fprintf(stderr, "%s: failed (error code %d)\n", code, result);
+    }
+
+    return passed;
+}
@@ -0,0 +1,25 @@
+#ifndef LIBABACUS_TEST_SUPPORT_H
+#define LIBABACUS_TEST_SUPPORT_H
+
+#include "libabacus.h"
+
+/**
+ * Initializes an instance whose numbers are doubles, and
+ * registers arithmetic and comparison operators for them.
+ * @param ab the instance to initialize.
+ * @return the result of the initialization.
+ */
+libab_result test_init(libab* ab);
+/**
+ * Runs the given code in the given scope, and checks
+ * that it evaluates to the expected number.
+ * @param ab the instance to run the code with.
+ * @param scope the scope to run the code in.
+ * @param code the code to run.
+ * @param expected the number the code should evaluate to.
+ * @return 1 if the check passed, 0 if it failed.
+ */
+int test_expect_num(libab* ab, libab_ref* scope, const char* code,
+                    double expected);
+
+#endif
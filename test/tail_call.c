@@ -0,0 +1,58 @@
+#include "support.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Counts down a million levels deep through a self-recursive
+ * tail call, which only fits on the stack if the call reuses
+ * the caller's frame.
+ */
+int test_tail_call_self(void) {
+    libab ab;
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    passed = test_expect_num(&ab, &ab.table,
+                             "fun count(n: num, acc: num): num { "
+                             "if (n < 1) { acc } "
+                             "else { count(n - 1, acc + 1) } }; "
+                             "count(1000000, 0)",
+                             1000000);
+    libab_free(&ab);
+
+    return passed;
+}
+
+/**
+ * Alternates a million levels deep between two functions
+ * that tail call each other.
+ */
+int test_tail_call_mutual(void) {
+    libab ab;
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    passed = test_expect_num(&ab, &ab.table,
+                             "fun ping(n: num): num { "
+                             "if (n < 1) { 0 } else { pong(n - 1) } }; "
+                             "fun pong(n: num): num { "
+                             "if (n < 1) { 1 } else { ping(n - 1) } }; "
+                             "ping(1000001)",
+                             1);
+    libab_free(&ab);
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_tail_call_self();
+    passed &= test_tail_call_mutual();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
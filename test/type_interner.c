@@ -0,0 +1,54 @@
+#include "support.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Interns a type whose children are already canonical, so that
+ * the canonical type is still a copy, and the given type is left
+ * as it was for its holder to change.
+ */
+int test_type_interner_copy(void) {
+    libab ab;
+    libab_ref function;
+    libab_ref canonical;
+    libab_ref again;
+    int passed = 0;
+
+    if (test_init(&ab) != LIBAB_SUCCESS) {
+        return 0;
+    }
+    if (libab_instantiate_basetype(libab_get_basetype_function(&ab),
+                                   &function, 2, &ab.type_num,
+                                   &ab.type_num) == LIBAB_SUCCESS) {
+        if (libab_type_interner_intern(&ab.types, &function, &canonical) ==
+            LIBAB_SUCCESS) {
+            if (libab_type_interner_intern(&ab.types, &function, &again) ==
+                LIBAB_SUCCESS) {
+                passed = libab_ref_get(&canonical) == libab_ref_get(&again) &&
+                         libab_ref_get(&canonical) != libab_ref_get(&function) &&
+                         !(((libab_parsetype*)libab_ref_get(&function))
+                               ->variant &
+                           LIBABACUS_TYPE_F_INTERNED);
+                libab_ref_free(&again);
+            }
+            libab_ref_free(&canonical);
+        }
+        libab_ref_free(&function);
+    }
+    libab_free(&ab);
+
+    if (!passed) {
+        fprintf(stderr, "interning changed the given type\n");
+    }
+
+    return passed;
+}
+
+int main() {
+    int passed = 1;
+
+    passed &= test_type_interner_copy();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}